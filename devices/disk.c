@@ -4,6 +4,7 @@
 #include <stdbool.h>
 #include <stdio.h>
 #include "devices/timer.h"
+#include "threads/deferred.h"
 #include "threads/io.h"
 #include "threads/interrupt.h"
 #include "threads/synch.h"
@@ -32,6 +33,7 @@
 #define STA_BSY 0x80            /* Busy. */
 #define STA_DRDY 0x40           /* Device Ready. */
 #define STA_DRQ 0x08            /* Data Request. */
+#define STA_ERR 0x01            /* Error. */
 
 /* Control Register bits. */
 #define CTL_SRST 0x04           /* Software Reset. */
@@ -47,6 +49,13 @@
 #define CMD_IDENTIFY_DEVICE 0xec        /* IDENTIFY DEVICE. */
 #define CMD_READ_SECTOR_RETRY 0x20      /* READ SECTOR with retries. */
 #define CMD_WRITE_SECTOR_RETRY 0x30     /* WRITE SECTOR with retries. */
+#define CMD_READ_MULTIPLE 0xc4          /* READ MULTIPLE. */
+#define CMD_WRITE_MULTIPLE 0xc5         /* WRITE MULTIPLE. */
+#define CMD_SET_MULTIPLE_MODE 0xc6      /* SET MULTIPLE MODE. */
+
+/* Most sectors that one command can transfer.  The Sector Count
+   register holds 0 for this many. */
+#define MAX_XFER_SECTORS 256
 
 /* An ATA device. */
 struct disk {
@@ -56,6 +65,8 @@ struct disk {
 
 	bool is_ata;                /* 1=This device is an ATA disk. */
 	disk_sector_t capacity;     /* Capacity in sectors (if is_ata). */
+	int multiple;               /* Sectors per interrupt under READ/WRITE
+								   MULTIPLE, or 0 if not supported. */
 
 	long long read_cnt;         /* Number of sectors read. */
 	long long write_cnt;        /* Number of sectors written. */
@@ -72,6 +83,7 @@ struct channel {
 	bool expecting_interrupt;   /* True if an interrupt is expected, false if
 								   any interrupt would be spurious. */
 	struct semaphore completion_wait;   /* Up'd by interrupt handler. */
+	struct deferred_work unexpected_work; /* Reports a spurious interrupt. */
 
 	struct disk devices[2];     /* The devices on this channel. */
 };
@@ -83,11 +95,12 @@ static struct channel channels[CHANNEL_CNT];
 static void reset_channel (struct channel *);
 static bool check_device_type (struct disk *);
 static void identify_ata_device (struct disk *);
+static void set_multiple_mode (struct disk *, int max);
 
-static void select_sector (struct disk *, disk_sector_t);
+static void select_sectors (struct disk *, disk_sector_t, size_t cnt);
 static void issue_pio_command (struct channel *, uint8_t command);
-static void input_sector (struct channel *, void *);
-static void output_sector (struct channel *, const void *);
+static void input_sectors (struct channel *, void *, size_t cnt);
+static void output_sectors (struct channel *, const void *, size_t cnt);
 
 static void wait_until_idle (const struct disk *);
 static bool wait_while_busy (const struct disk *);
@@ -95,6 +108,7 @@ static void select_device (const struct disk *);
 static void select_device_wait (const struct disk *);
 
 static void interrupt_handler (struct intr_frame *);
+static deferred_func report_unexpected;
 
 /* Initialize the disk subsystem and detect disks. */
 void
@@ -122,6 +136,7 @@ disk_init (void) {
 		lock_init (&c->lock);
 		c->expecting_interrupt = false;
 		sema_init (&c->completion_wait, 0);
+		deferred_work_init (&c->unexpected_work, report_unexpected, c);
 
 		/* Initialize devices. */
 		for (dev_no = 0; dev_no < 2; dev_no++) {
@@ -132,6 +147,7 @@ disk_init (void) {
 
 			d->is_ata = false;
 			d->capacity = 0;
+			d->multiple = 0;
 
 			d->read_cnt = d->write_cnt = 0;
 		}
@@ -209,47 +225,119 @@ disk_size (struct disk *d) {
    per-disk locking is unneeded. */
 void
 disk_read (struct disk *d, disk_sector_t sec_no, void *buffer) {
+	disk_read_multiple (d, sec_no, 1, buffer);
+}
+
+/* Write sector SEC_NO to disk D from BUFFER, which must contain
+   DISK_SECTOR_SIZE bytes.  Returns after the disk has
+   acknowledged receiving the data.
+   Internally synchronizes accesses to disks, so external
+   per-disk locking is unneeded. */
+void
+disk_write (struct disk *d, disk_sector_t sec_no, const void *buffer) {
+	disk_write_multiple (d, sec_no, 1, buffer);
+}
+
+/* Returns the number of sectors that disk D moves per interrupt
+   in a transfer of CNT sectors.  More than one means the transfer
+   uses READ/WRITE MULTIPLE. */
+static size_t
+block_size (const struct disk *d, size_t cnt) {
+	return cnt > 1 && d->multiple > 1 ? (size_t) d->multiple : 1;
+}
+
+/* Reads the CNT sectors starting at SEC_NO from disk D into
+   BUFFER, which must have room for CNT * DISK_SECTOR_SIZE bytes.
+   Issues one command per MAX_XFER_SECTORS sectors instead of one
+   per sector.
+   Internally synchronizes accesses to disks, so external
+   per-disk locking is unneeded. */
+void
+disk_read_multiple (struct disk *d, disk_sector_t sec_no, size_t cnt,
+		void *buffer) {
 	struct channel *c;
+	uint8_t *p = buffer;
 
 	ASSERT (d != NULL);
 	ASSERT (buffer != NULL);
 
 	c = d->channel;
 	lock_acquire (&c->lock);
-	select_sector (d, sec_no);
-	issue_pio_command (c, CMD_READ_SECTOR_RETRY);
-	sema_down (&c->completion_wait);
-	if (!wait_while_busy (d))
-		PANIC ("%s: disk read failed, sector=%"PRDSNu, d->name, sec_no);
-	input_sector (c, buffer);
-	d->read_cnt++;
+	while (cnt > 0) {
+		size_t n = cnt < MAX_XFER_SECTORS ? cnt : MAX_XFER_SECTORS;
+		size_t block = block_size (d, n);
+		size_t i;
+
+		select_sectors (d, sec_no, n);
+		issue_pio_command (c, block > 1 ? CMD_READ_MULTIPLE
+				: CMD_READ_SECTOR_RETRY);
+
+		/* The disk interrupts once each block is ready. */
+		for (i = 0; i < n; i += block) {
+			size_t k = n - i < block ? n - i : block;
+
+			sema_down (&c->completion_wait);
+			if (!wait_while_busy (d))
+				PANIC ("%s: disk read failed, sector=%"PRDSNu, d->name,
+						(disk_sector_t) (sec_no + i));
+			input_sectors (c, p + i * DISK_SECTOR_SIZE, k);
+		}
+		d->read_cnt += n;
+
+		sec_no += n;
+		p += n * DISK_SECTOR_SIZE;
+		cnt -= n;
+	}
 	lock_release (&c->lock);
 }
 
-/* Write sector SEC_NO to disk D from BUFFER, which must contain
-   DISK_SECTOR_SIZE bytes.  Returns after the disk has
-   acknowledged receiving the data.
+/* Writes the CNT sectors starting at SEC_NO on disk D from
+   BUFFER, which must contain CNT * DISK_SECTOR_SIZE bytes.
+   Returns after the disk has acknowledged receiving the data.
+   Issues one command per MAX_XFER_SECTORS sectors instead of one
+   per sector.
    Internally synchronizes accesses to disks, so external
    per-disk locking is unneeded. */
 void
-disk_write (struct disk *d, disk_sector_t sec_no, const void *buffer) {
+disk_write_multiple (struct disk *d, disk_sector_t sec_no, size_t cnt,
+		const void *buffer) {
 	struct channel *c;
+	const uint8_t *p = buffer;
 
 	ASSERT (d != NULL);
 	ASSERT (buffer != NULL);
 
 	c = d->channel;
 	lock_acquire (&c->lock);
-	select_sector (d, sec_no);
-	issue_pio_command (c, CMD_WRITE_SECTOR_RETRY);
-	if (!wait_while_busy (d))
-		PANIC ("%s: disk write failed, sector=%"PRDSNu, d->name, sec_no);
-	output_sector (c, buffer);
-	sema_down (&c->completion_wait);
-	d->write_cnt++;
+	while (cnt > 0) {
+		size_t n = cnt < MAX_XFER_SECTORS ? cnt : MAX_XFER_SECTORS;
+		size_t block = block_size (d, n);
+		size_t i;
+
+		select_sectors (d, sec_no, n);
+		issue_pio_command (c, block > 1 ? CMD_WRITE_MULTIPLE
+				: CMD_WRITE_SECTOR_RETRY);
+
+		/* The disk asks for the first block at once and interrupts
+		   once it has taken each block. */
+		for (i = 0; i < n; i += block) {
+			size_t k = n - i < block ? n - i : block;
+
+			if (!wait_while_busy (d))
+				PANIC ("%s: disk write failed, sector=%"PRDSNu, d->name,
+						(disk_sector_t) (sec_no + i));
+			output_sectors (c, p + i * DISK_SECTOR_SIZE, k);
+			sema_down (&c->completion_wait);
+		}
+		d->write_cnt += n;
+
+		sec_no += n;
+		p += n * DISK_SECTOR_SIZE;
+		cnt -= n;
+	}
 	lock_release (&c->lock);
 }
-
+
 /* Disk detection and identification. */
 
 static void print_ata_string (char *string, size_t size);
@@ -359,11 +447,15 @@ identify_ata_device (struct disk *d) {
 		d->is_ata = false;
 		return;
 	}
-	input_sector (c, id);
+	input_sectors (c, id, 1);
 
 	/* Calculate capacity. */
 	d->capacity = id[60] | ((uint32_t) id[61] << 16);
 
+	/* Bits 7:0 of word 47 give the most sectors per interrupt that
+	   READ/WRITE MULTIPLE supports, or 0 if it does not. */
+	set_multiple_mode (d, id[47] & 0xff);
+
 	/* Print identification message. */
 	printf ("%s: detected %'"PRDSNu" sector (", d->name, d->capacity);
 	if (d->capacity > 1024 / DISK_SECTOR_SIZE * 1024 * 1024)
@@ -382,6 +474,31 @@ identify_ata_device (struct disk *d) {
 	printf ("\"\n");
 }
 
+/* Enables READ/WRITE MULTIPLE on disk D with the largest power
+   of two that does not exceed MAX sectors per interrupt, and sets
+   D's multiple member to it.  Leaves the member 0 if MAX is 0 or
+   the disk rejects the command. */
+static void
+set_multiple_mode (struct disk *d, int max) {
+	struct channel *c = d->channel;
+	int cnt;
+
+	d->multiple = 0;
+	if (max == 0)
+		return;
+
+	for (cnt = 1; cnt * 2 <= max; cnt *= 2)
+		continue;
+
+	select_device_wait (d);
+	outb (reg_nsect (c), cnt);
+	issue_pio_command (c, CMD_SET_MULTIPLE_MODE);
+	sema_down (&c->completion_wait);
+	wait_while_busy (d);
+	if ((inb (reg_alt_status (c)) & STA_ERR) == 0)
+		d->multiple = cnt;
+}
+
 /* Prints STRING, which consists of SIZE bytes in a funky format:
    each pair of bytes is in reverse order.  Does not print
    trailing whitespace and/or nulls. */
@@ -402,17 +519,19 @@ print_ata_string (char *string, size_t size) {
 }
 
 /* Selects device D, waiting for it to become ready, and then
-   writes SEC_NO to the disk's sector selection registers.  (We
-   use LBA mode.) */
+   writes SEC_NO and CNT to the disk's sector selection registers
+   to address the CNT sectors starting at SEC_NO.  (We use LBA
+   mode.) */
 static void
-select_sector (struct disk *d, disk_sector_t sec_no) {
+select_sectors (struct disk *d, disk_sector_t sec_no, size_t cnt) {
 	struct channel *c = d->channel;
 
-	ASSERT (sec_no < d->capacity);
-	ASSERT (sec_no < (1UL << 28));
+	ASSERT (cnt > 0 && cnt <= MAX_XFER_SECTORS);
+	ASSERT (sec_no < d->capacity && cnt <= d->capacity - sec_no);
+	ASSERT (sec_no + cnt <= (1UL << 28));
 
 	select_device_wait (d);
-	outb (reg_nsect (c), 1);
+	outb (reg_nsect (c), cnt == MAX_XFER_SECTORS ? 0 : cnt);
 	outb (reg_lbal (c), sec_no);
 	outb (reg_lbam (c), sec_no >> 8);
 	outb (reg_lbah (c), (sec_no >> 16));
@@ -432,18 +551,19 @@ issue_pio_command (struct channel *c, uint8_t command) {
 	outb (reg_command (c), command);
 }
 
-/* Reads a sector from channel C's data register in PIO mode into
-   SECTOR, which must have room for DISK_SECTOR_SIZE bytes. */
+/* Reads CNT sectors from channel C's data register in PIO mode
+   into SECTORS, which must have room for CNT * DISK_SECTOR_SIZE
+   bytes. */
 static void
-input_sector (struct channel *c, void *sector) {
-	insw (reg_data (c), sector, DISK_SECTOR_SIZE / 2);
+input_sectors (struct channel *c, void *sectors, size_t cnt) {
+	insw (reg_data (c), sectors, cnt * DISK_SECTOR_SIZE / 2);
 }
 
-/* Writes SECTOR to channel C's data register in PIO mode.
-   SECTOR must contain DISK_SECTOR_SIZE bytes. */
+/* Writes CNT sectors from SECTORS to channel C's data register in
+   PIO mode.  SECTORS must contain CNT * DISK_SECTOR_SIZE bytes. */
 static void
-output_sector (struct channel *c, const void *sector) {
-	outsw (reg_data (c), sector, DISK_SECTOR_SIZE / 2);
+output_sectors (struct channel *c, const void *sectors, size_t cnt) {
+	outsw (reg_data (c), sectors, cnt * DISK_SECTOR_SIZE / 2);
 }
 
 /* Low-level ATA primitives. */
@@ -511,7 +631,11 @@ select_device_wait (const struct disk *d) {
 	wait_until_idle (d);
 }
 
-/* ATA interrupt handler. */
+/* ATA interrupt handler.  Reading the status register is what
+   acknowledges the interrupt, so it cannot wait, and waking the
+   one thread that waits for the command is cheaper than queuing
+   work to do it.  Only the message about an unexpected
+   interrupt, which is slow to print, is deferred. */
 static void
 interrupt_handler (struct intr_frame *f) {
 	struct channel *c;
@@ -522,13 +646,22 @@ interrupt_handler (struct intr_frame *f) {
 				inb (reg_status (c));               /* Acknowledge interrupt. */
 				sema_up (&c->completion_wait);      /* Wake up waiter. */
 			} else
-				printf ("%s: unexpected interrupt\n", c->name);
+				deferred_schedule (&c->unexpected_work, DEFERRED_NORMAL);
 			return;
 		}
 
 	NOT_REACHED ();
 }
 
+/* Reports an interrupt that channel C_ raised when none was
+   expected.  Runs on the deferred work thread. */
+static void
+report_unexpected (void *c_) {
+	struct channel *c = c_;
+
+	printf ("%s: unexpected interrupt\n", c->name);
+}
+
 static void
 inspect_read_cnt (struct intr_frame *f) {
 	struct disk * d = disk_get (f->R.rdx, f->R.rcx);
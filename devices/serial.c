@@ -5,6 +5,7 @@
 #include "devices/timer.h"
 #include "threads/io.h"
 #include "threads/interrupt.h"
+#include "threads/deferred.h"
 #include "threads/synch.h"
 #include "threads/thread.h"
 
@@ -54,10 +55,17 @@ static enum { UNINIT, POLL, QUEUE } mode;
 /* Data to be transmitted. */
 static struct intq txq;
 
+/* Moves bytes from TXQ to the UART outside the interrupt
+   handler.  While it is pending or running, TX_DEFERRED is true
+   and the transmit interrupt stays off. */
+static struct deferred_work tx_work;
+static bool tx_deferred;
+
 static void set_serial (int bps);
 static void putc_poll (uint8_t);
 static void write_ier (void);
 static intr_handler_func serial_interrupt;
+static deferred_func transmit;
 
 /* Initializes the serial port device for polling mode.
    Polling mode busy-waits for the serial port to become free
@@ -85,6 +93,7 @@ serial_init_queue (void) {
 		init_poll ();
 	ASSERT (mode == POLL);
 
+	deferred_work_init (&tx_work, transmit, NULL);
 	intr_register_ext (0x20 + 4, serial_interrupt, "serial");
 	mode = QUEUE;
 	old_level = intr_disable ();
@@ -106,12 +115,14 @@ serial_putc (uint8_t byte) {
 	} else {
 		/* Otherwise, queue a byte and update the interrupt enable
 		   register. */
-		if (old_level == INTR_OFF && intq_full (&txq)) {
+		if ((old_level == INTR_OFF || deferred_is_worker (thread_current ()))
+				&& intq_full (&txq)) {
 			/* Interrupts are off and the transmit queue is full.
 			   If we wanted to wait for the queue to empty,
 			   we'd have to reenable interrupts.
 			   That's impolite, so we'll send a character via
-			   polling instead. */
+			   polling instead.  The deferred work thread, which
+			   empties the queue, must not wait for it either. */
 			putc_poll (intq_getc (&txq));
 		}
 
@@ -170,8 +181,8 @@ write_ier (void) {
 	ASSERT (intr_get_level () == INTR_OFF);
 
 	/* Enable transmit interrupt if we have any characters to
-	   transmit. */
-	if (!intq_empty (&txq))
+	   transmit and transmit() is not already sending them. */
+	if (!intq_empty (&txq) && !tx_deferred)
 		ier |= IER_XMIT;
 
 	/* Enable receive interrupt if we have room to store any
@@ -205,11 +216,33 @@ serial_interrupt (struct intr_frame *f UNUSED) {
 	while (!input_full () && (inb (LSR_REG) & LSR_DR) != 0)
 		input_putc (inb (RBR_REG));
 
-	/* As long as we have a byte to transmit, and the hardware is
-	   ready to accept a byte for transmission, transmit a byte. */
-	while (!intq_empty (&txq) && (inb (LSR_REG) & LSR_THRE) != 0)
-		outb (THR_REG, intq_getc (&txq));
+	/* If we have bytes to transmit and the hardware is ready to
+	   accept them, leave the sending to transmit(), which does
+	   not keep interrupts off between bytes. */
+	if (!intq_empty (&txq) && (inb (LSR_REG) & LSR_THRE) != 0) {
+		tx_deferred = true;
+		deferred_schedule (&tx_work, DEFERRED_NORMAL);
+	}
 
 	/* Update interrupt enable register based on queue status. */
 	write_ier ();
 }
+
+/* Transmits bytes from the queue for as long as the hardware
+   accepts them, turning interrupts off for one byte at a time,
+   then turns the transmit interrupt back on if any are left.
+   Runs on the deferred work thread. */
+static void
+transmit (void *aux UNUSED) {
+	for (;;) {
+		enum intr_level old_level = intr_disable ();
+		if (intq_empty (&txq) || (inb (LSR_REG) & LSR_THRE) == 0) {
+			tx_deferred = false;
+			write_ier ();
+			intr_set_level (old_level);
+			return;
+		}
+		outb (THR_REG, intq_getc (&txq));
+		intr_set_level (old_level);
+	}
+}
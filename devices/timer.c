@@ -3,6 +3,7 @@
 #include <inttypes.h>
 #include <round.h>
 #include <stdio.h>
+#include "threads/deferred.h"
 #include "threads/interrupt.h"
 #include "threads/io.h"
 #include "threads/synch.h"
@@ -17,8 +18,36 @@
 #error TIMER_FREQ <= 1000 recommended
 #endif
 
-/* Number of timer ticks since OS booted. */
+/* 8254 input frequency. */
+#define PIT_HZ 1193180
+
+/* 8254 counts per timer tick, rounded to nearest. */
+#define PIT_COUNT ((PIT_HZ + TIMER_FREQ / 2) / TIMER_FREQ)
+
+/* Longest one-shot period the 16-bit counter can hold, in ticks. */
+#define ONESHOT_MAX_TICKS (0xffff / PIT_COUNT)
+
+/* Number of timer ticks since OS booted.  Written only by the
+   timer interrupt handler and timer_idle_exit(), with interrupts
+   off, under TICKS_SEQ. */
 static int64_t ticks;
+static struct seqlock ticks_seq;
+
+/* If true, stop the periodic tick while the CPU is idle.
+   Controlled by kernel command-line option "-tickless". */
+bool timer_tickless;
+
+/* Ticks covered by the one-shot period that is currently
+   programmed, or 0 if the timer is in periodic mode. */
+static int64_t oneshot_ticks;
+
+/* Once-per-second MLFQS refresh of the run queue, run outside the
+   timer interrupt. */
+static struct deferred_work refresh_work;
+
+/* Statistics. */
+static long long oneshot_cnt;	/* # of one-shot periods programmed. */
+static long long skipped_ticks; /* # of tick interrupts avoided. */
 
 /* Number of loops per timer tick.
    Initialized by timer_calibrate(). */
@@ -28,19 +57,21 @@ static intr_handler_func timer_interrupt;
 static bool too_many_loops(unsigned loops);
 static void busy_wait(int64_t loops);
 static void real_time_sleep(int64_t num, int32_t denom);
+static void ticks_add(int64_t n);
+static void pit_program(uint8_t cw, uint16_t count);
+static uint16_t pit_read_count(void);
+static bool pit_output_high(void);
+static deferred_func refresh_ready;
 
 /* Sets up the 8254 Programmable Interval Timer (PIT) to
    interrupt PIT_FREQ times per second, and registers the
    corresponding interrupt. */
 void timer_init(void)
 {
-	/* 8254 input frequency divided by TIMER_FREQ, rounded to
-	   nearest. */
-	uint16_t count = (1193180 + TIMER_FREQ / 2) / TIMER_FREQ;
+	pit_program(0x34, PIT_COUNT); /* CW: counter 0, LSB then MSB, mode 2, binary. */
 
-	outb(0x43, 0x34); /* CW: counter 0, LSB then MSB, mode 2, binary. */
-	outb(0x40, count & 0xff);
-	outb(0x40, count >> 8);
+	seqlock_init(&ticks_seq);
+	deferred_work_init(&refresh_work, refresh_ready, NULL);
 
 	intr_register_ext(0x20, timer_interrupt, "8254 Timer");
 }
@@ -75,10 +106,14 @@ void timer_calibrate(void)
 int64_t
 timer_ticks(void)
 {
-	enum intr_level old_level = intr_disable();
-	int64_t t = ticks;
-	intr_set_level(old_level);
-	barrier();
+	unsigned seq;
+	int64_t t;
+
+	do
+	{
+		seq = seqlock_read_begin(&ticks_seq);
+		t = ticks;
+	} while (seqlock_read_retry(&ticks_seq, seq));
 	return t;
 }
 
@@ -119,29 +154,114 @@ void timer_nsleep(int64_t ns)
 void timer_print_stats(void)
 {
 	printf("Timer: %" PRId64 " ticks\n", timer_ticks());
+	if (timer_tickless)
+		printf("Timer: %lld one-shot periods, %lld tick interrupts skipped\n",
+			   oneshot_cnt, skipped_ticks);
+}
+
+/* Called by the idle thread, with interrupts off, right before
+   it halts the CPU.  In tickless mode, replaces the periodic
+   tick by a single interrupt at the next tick on which a
+   sleeping thread must wake up.  The one-shot period ends on a
+   tick boundary, so timer_ticks() stays in step with the
+   periodic schedule. */
+void timer_idle_enter(void)
+{
+	int64_t delta;
+	uint16_t left;
+
+	ASSERT(intr_get_level() == INTR_OFF);
+
+	/* The MLFQS needs to see every tick. */
+	if (!timer_tickless || thread_mlfqs || oneshot_ticks != 0)
+		return;
+
+	delta = get_next_tick_to_awake() - ticks;
+	if (delta <= 1)
+		return;
+	if (delta > ONESHOT_MAX_TICKS)
+		delta = ONESHOT_MAX_TICKS;
+
+	/* Counts left until the next periodic tick, then whole
+	   ticks after it. */
+	left = pit_read_count();
+	if (left == 0 || left > PIT_COUNT)
+		left = PIT_COUNT;
+
+	oneshot_ticks = delta;
+	oneshot_cnt++;
+	pit_program(0x30, left + (delta - 1) * PIT_COUNT); /* CW: counter 0, LSB then MSB, mode 0, binary. */
+}
+
+/* Called by the idle thread, with interrupts off, after an
+   interrupt woke it from halt.  If the wakeup came from some
+   other device before the one-shot period ran out, credits the
+   ticks that have already elapsed and shortens the period so
+   that it ends at the next tick boundary. */
+void timer_idle_exit(void)
+{
+	uint16_t left;
+	int64_t remaining;
+
+	ASSERT(intr_get_level() == INTR_OFF);
+
+	if (oneshot_ticks == 0)
+		return;
+
+	/* Already expired: the pending timer interrupt will do the
+	   bookkeeping. */
+	if (pit_output_high())
+		return;
+
+	left = pit_read_count();
+	remaining = DIV_ROUND_UP(left, PIT_COUNT);
+	if (remaining == 0 || remaining > oneshot_ticks)
+		return;
+
+	ticks_add(oneshot_ticks - remaining);
+	skipped_ticks += oneshot_ticks - remaining;
+	oneshot_ticks = 1;
+	pit_program(0x30, left - (remaining - 1) * PIT_COUNT);
 }
 
 /* Timer interrupt handler. */
 static void
 timer_interrupt(struct intr_frame *args UNUSED)
 {
-	ticks++;
+	if (oneshot_ticks != 0)
+	{
+		/* End of a one-shot period: account for the ticks we slept
+		   through and go back to the periodic tick. */
+		int64_t slept = oneshot_ticks;
+
+		oneshot_ticks = 0;
+		pit_program(0x34, PIT_COUNT);
+		for (; slept > 1; slept--)
+		{
+			ticks_add(1);
+			skipped_ticks++;
+			thread_tick();
+		}
+	}
+
+	ticks_add(1);
 	thread_tick();
 
 	if (thread_mlfqs)
 	{
 		mlfqs_increment();
 
-		if (ticks % 4 == 0)
+		/* Everything done here is O(1): blocked threads are decayed
+		   lazily when they wake up, and the run queue is refreshed
+		   by the worker thread. */
+		if (ticks % TIMER_FREQ == 0)
 		{
-			mlfqs_recalc_priority();
-
-			if (ticks % TIMER_FREQ == 0)
-			{
-				mlfqs_recalc_recent_cpu();
-				mlfqs_load_avg();
-			}
+			mlfqs_load_avg();
+			mlfqs_decay();
+			deferred_schedule(&refresh_work, DEFERRED_HIGH);
 		}
+		if (ticks % 4 == 0)
+			mlfqs_update_current();
 	}
 
 	int64_t next_tick = get_next_tick_to_awake();
@@ -149,6 +269,53 @@ timer_interrupt(struct intr_frame *args UNUSED)
 		thread_awake(ticks);
 }
 
+/* Deferred work: decays and reprioritizes the ready threads. */
+static void
+refresh_ready(void *aux UNUSED)
+{
+	mlfqs_refresh_ready();
+}
+
+/* Advances the tick count by N.  Interrupts must be off. */
+static void
+ticks_add(int64_t n)
+{
+	seqlock_write_begin(&ticks_seq);
+	ticks += n;
+	seqlock_write_end(&ticks_seq);
+}
+
+/* Writes control word CW to the 8254 and loads COUNT into
+   counter 0. */
+static void
+pit_program(uint8_t cw, uint16_t count)
+{
+	outb(0x43, cw);
+	outb(0x40, count & 0xff);
+	outb(0x40, count >> 8);
+}
+
+/* Returns the current value of counter 0. */
+static uint16_t
+pit_read_count(void)
+{
+	uint8_t lo, hi;
+
+	outb(0x43, 0x00); /* CW: counter 0, counter latch. */
+	lo = inb(0x40);
+	hi = inb(0x40);
+	return lo | (hi << 8);
+}
+
+/* Returns true if counter 0's output is high, which in mode 0
+   means that the count has reached terminal count. */
+static bool
+pit_output_high(void)
+{
+	outb(0x43, 0xe2); /* CW: read-back, status only, counter 0. */
+	return (inb(0x40) & 0x80) != 0;
+}
+
 /* Returns true if LOOPS iterations waits for more than one timer
    tick, otherwise false. */
 static bool
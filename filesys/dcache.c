@@ -0,0 +1,205 @@
+/* dcache.c: Cache of directory lookups. */
+
+#include "filesys/dcache.h"
+#include <debug.h>
+#include <hash.h>
+#include <list.h>
+#include <stdio.h>
+#include <string.h>
+#include "filesys/directory.h"
+#include "filesys/inode.h"
+#include "threads/synch.h"
+
+/* Dentry cache.
+ *
+ * Remembers the result of looking up a name in a directory,
+ * keyed by the directory's inode sector and the name: either the
+ * sector of the inode the name refers to, or DCACHE_NEGATIVE if
+ * the directory has no such name.  A path lookup whose components
+ * are all cached does not search any directory.  Entries are
+ * recycled in least-recently-used order.
+ *
+ * directory.c keeps the cache coherent.  It inserts results and
+ * invalidates names under the directory's lock, so a lookup
+ * cannot cache a result that a concurrent dir_add() or
+ * dir_remove() has made stale.  When a directory is removed, its
+ * sector may be reused for a new directory, so dir_remove() marks
+ * it removed and then purges its entries; dcache_insert() refuses
+ * entries for removed directories, and both run under DCACHE_LOCK,
+ * so no entry for the old directory can survive. */
+
+/* Number of cached names. */
+#define DCACHE_SIZE 256
+
+/* A cached name. */
+struct dentry {
+	struct hash_elem hash_elem;     /* Element in dentries. */
+	struct list_elem lru_elem;      /* Element in lru or free list. */
+	disk_sector_t dir;              /* Sector of the directory. */
+	char name[NAME_MAX + 1];        /* Name within DIR. */
+	disk_sector_t sector;           /* Result, or DCACHE_NEGATIVE. */
+};
+
+static struct dentry dentry_pool[DCACHE_SIZE];
+static struct hash dentries;        /* Cached names. */
+static struct list lru;             /* Cached names, most recent first. */
+static struct list free_dentries;   /* Unused pool entries. */
+static struct lock dcache_lock;
+
+/* Statistics. */
+static long long dcache_hits;       /* Lookups answered by the cache. */
+static long long dcache_misses;     /* Lookups that searched a directory. */
+
+static struct dentry *dcache_find (disk_sector_t dir, const char *name);
+
+/* Returns a hash value for the dentry containing E. */
+static uint64_t
+dentry_hash (const struct hash_elem *e, void *aux UNUSED) {
+	const struct dentry *d = hash_entry (e, struct dentry, hash_elem);
+
+	return hash_bytes (&d->dir, sizeof d->dir) ^ hash_string (d->name);
+}
+
+/* Returns true if the dentry containing A precedes the one
+ * containing B. */
+static bool
+dentry_less (const struct hash_elem *a, const struct hash_elem *b,
+		void *aux UNUSED) {
+	const struct dentry *da = hash_entry (a, struct dentry, hash_elem);
+	const struct dentry *db = hash_entry (b, struct dentry, hash_elem);
+
+	if (da->dir != db->dir)
+		return da->dir < db->dir;
+	return strcmp (da->name, db->name) < 0;
+}
+
+/* Initializes the dentry cache. */
+void
+dcache_init (void) {
+	size_t i;
+
+	if (!hash_init (&dentries, dentry_hash, dentry_less, NULL))
+		PANIC ("dentry cache init failed");
+	list_init (&lru);
+	list_init (&free_dentries);
+	lock_init (&dcache_lock);
+	for (i = 0; i < DCACHE_SIZE; i++)
+		list_push_back (&free_dentries, &dentry_pool[i].lru_elem);
+}
+
+/* Looks up NAME in directory DIR.  Returns true and sets *SECTOR
+ * to the cached result if there is one, otherwise returns false. */
+bool
+dcache_lookup (struct inode *dir, const char *name, disk_sector_t *sector) {
+	struct dentry *d;
+
+	lock_acquire (&dcache_lock);
+	d = dcache_find (inode_get_inumber (dir), name);
+	if (d != NULL) {
+		dcache_hits++;
+		*sector = d->sector;
+		list_remove (&d->lru_elem);
+		list_push_front (&lru, &d->lru_elem);
+	} else
+		dcache_misses++;
+	lock_release (&dcache_lock);
+	return d != NULL;
+}
+
+/* Records that NAME in directory DIR refers to SECTOR, or does not
+ * exist if SECTOR is DCACHE_NEGATIVE.  Does nothing if DIR has
+ * been removed.  The caller must hold DIR's directory lock. */
+void
+dcache_insert (struct inode *dir, const char *name, disk_sector_t sector) {
+	struct dentry *d;
+
+	if (strlen (name) > NAME_MAX)
+		return;
+
+	lock_acquire (&dcache_lock);
+	if (inode_is_removed (dir)) {
+		lock_release (&dcache_lock);
+		return;
+	}
+
+	d = dcache_find (inode_get_inumber (dir), name);
+	if (d != NULL)
+		list_remove (&d->lru_elem);
+	else {
+		if (!list_empty (&free_dentries))
+			d = list_entry (list_pop_front (&free_dentries),
+					struct dentry, lru_elem);
+		else {
+			d = list_entry (list_pop_back (&lru), struct dentry, lru_elem);
+			hash_delete (&dentries, &d->hash_elem);
+		}
+		d->dir = inode_get_inumber (dir);
+		strlcpy (d->name, name, sizeof d->name);
+		hash_insert (&dentries, &d->hash_elem);
+	}
+	d->sector = sector;
+	list_push_front (&lru, &d->lru_elem);
+	lock_release (&dcache_lock);
+}
+
+/* Forgets NAME in directory DIR.  The caller must hold DIR's
+ * directory lock. */
+void
+dcache_invalidate (struct inode *dir, const char *name) {
+	struct dentry *d;
+
+	lock_acquire (&dcache_lock);
+	d = dcache_find (inode_get_inumber (dir), name);
+	if (d != NULL) {
+		hash_delete (&dentries, &d->hash_elem);
+		list_remove (&d->lru_elem);
+		list_push_back (&free_dentries, &d->lru_elem);
+	}
+	lock_release (&dcache_lock);
+}
+
+/* Forgets every name in directory DIR, which must have been
+ * marked removed. */
+void
+dcache_purge (struct inode *dir) {
+	disk_sector_t sector = inode_get_inumber (dir);
+	struct list_elem *e;
+
+	ASSERT (inode_is_removed (dir));
+
+	lock_acquire (&dcache_lock);
+	for (e = list_begin (&lru); e != list_end (&lru);) {
+		struct dentry *d = list_entry (e, struct dentry, lru_elem);
+
+		e = list_next (e);
+		if (d->dir == sector) {
+			hash_delete (&dentries, &d->hash_elem);
+			list_remove (&d->lru_elem);
+			list_push_back (&free_dentries, &d->lru_elem);
+		}
+	}
+	lock_release (&dcache_lock);
+}
+
+/* Prints dentry cache statistics. */
+void
+dcache_print_stats (void) {
+	printf ("Dentry cache: %lld hits, %lld misses\n",
+			dcache_hits, dcache_misses);
+}
+
+/* Returns the cached entry for NAME in the directory at sector
+ * DIR, or a null pointer.  The caller must hold DCACHE_LOCK. */
+static struct dentry *
+dcache_find (disk_sector_t dir, const char *name) {
+	struct dentry key;
+	struct hash_elem *e;
+
+	if (strlen (name) > NAME_MAX)
+		return NULL;
+
+	key.dir = dir;
+	strlcpy (key.name, name, sizeof key.name);
+	e = hash_find (&dentries, &key.hash_elem);
+	return e != NULL ? hash_entry (e, struct dentry, hash_elem) : NULL;
+}
@@ -1,7 +1,9 @@
 #include "filesys/directory.h"
 #include <stdio.h>
 #include <string.h>
+#include <hash.h>
 #include <list.h>
+#include "filesys/dcache.h"
 #include "filesys/filesys.h"
 #include "filesys/inode.h"
 #include "filesys/fat.h"
@@ -23,6 +25,34 @@ struct dir_entry
 	bool in_use;				/* In use or free? */
 };
 
+/* In-memory index of a directory's entries, shared by every open
+ * of the directory through its inode.  dir_index_get() builds it
+ * with one pass over the directory, and dir_add() and dir_remove()
+ * keep it up to date, so that finding a name or a free slot does
+ * not read the directory entry by entry.  It is only a cache: if
+ * memory runs out the directory is searched on disk as before.
+ * Protected by the inode's directory lock. */
+struct dir_index
+{
+	struct hash names;		/* Slots in use, keyed by name. */
+	struct list free_slots; /* Slots of free entries. */
+	off_t end;				/* Offset just past the last entry. */
+};
+
+/* One entry of a directory, as recorded in its dir_index. */
+struct dir_slot
+{
+	struct hash_elem hash_elem; /* Element in names. */
+	struct list_elem list_elem; /* Element in free_slots. */
+	off_t ofs;					/* Byte offset of the entry. */
+	disk_sector_t inode_sector; /* Sector number of header. */
+	char name[NAME_MAX + 1];	/* Null terminated file name. */
+};
+
+static hash_hash_func slot_hash;
+static hash_less_func slot_less;
+static hash_action_func slot_free;
+
 /* Creates a directory with space for ENTRY_CNT entries in the
  * given SECTOR.  Returns true if successful, false on failure. */
 bool dir_create(disk_sector_t sector, size_t entry_cnt)
@@ -87,20 +117,141 @@ dir_get_inode(struct dir *dir)
 	return dir->inode;
 }
 
+/* Returns a hash value for the dir_slot containing E. */
+static uint64_t
+slot_hash(const struct hash_elem *e, void *aux UNUSED)
+{
+	return hash_string(hash_entry(e, struct dir_slot, hash_elem)->name);
+}
+
+/* Returns true if the name in A precedes the name in B. */
+static bool
+slot_less(const struct hash_elem *a, const struct hash_elem *b, void *aux UNUSED)
+{
+	return strcmp(hash_entry(a, struct dir_slot, hash_elem)->name,
+				  hash_entry(b, struct dir_slot, hash_elem)->name) < 0;
+}
+
+/* Frees the dir_slot containing E. */
+static void
+slot_free(struct hash_elem *e, void *aux UNUSED)
+{
+	free(hash_entry(e, struct dir_slot, hash_elem));
+}
+
+/* Frees INDEX.  Called when the directory's inode is closed for
+ * the last time. */
+void dir_index_destroy(struct dir_index *index)
+{
+	if (index == NULL)
+		return;
+
+	hash_destroy(&index->names, slot_free);
+	while (!list_empty(&index->free_slots))
+		free(list_entry(list_pop_front(&index->free_slots), struct dir_slot, list_elem));
+	free(index);
+}
+
+/* Records the entry E at byte offset OFS in INDEX.
+ * Returns false if out of memory. */
+static bool
+index_add(struct dir_index *index, const struct dir_entry *e, off_t ofs)
+{
+	struct dir_slot *slot = malloc(sizeof *slot);
+	if (slot == NULL)
+		return false;
+
+	slot->ofs = ofs;
+	slot->inode_sector = e->inode_sector;
+	strlcpy(slot->name, e->name, sizeof slot->name);
+	if (e->in_use)
+		hash_insert(&index->names, &slot->hash_elem);
+	else
+		list_push_back(&index->free_slots, &slot->list_elem);
+	if (ofs + (off_t)sizeof *e > index->end)
+		index->end = ofs + sizeof *e;
+	return true;
+}
+
+/* Returns the slot for NAME in INDEX, or a null pointer. */
+static struct dir_slot *
+index_find(struct dir_index *index, const char *name)
+{
+	struct dir_slot key;
+	struct hash_elem *e;
+
+	strlcpy(key.name, name, sizeof key.name);
+	e = hash_find(&index->names, &key.hash_elem);
+	return e != NULL ? hash_entry(e, struct dir_slot, hash_elem) : NULL;
+}
+
+/* Returns DIR's index, building it on first use, or a null pointer
+ * if memory runs out.  The caller must hold DIR's directory lock. */
+static struct dir_index *
+dir_index_get(const struct dir *dir)
+{
+	struct dir_index *index = inode_get_dir_index(dir->inode);
+	struct dir_entry e;
+	off_t ofs;
+
+	if (index != NULL)
+		return index;
+
+	index = malloc(sizeof *index);
+	if (index == NULL)
+		return NULL;
+	if (!hash_init(&index->names, slot_hash, slot_less, NULL))
+	{
+		free(index);
+		return NULL;
+	}
+	list_init(&index->free_slots);
+	index->end = 0;
+
+	for (ofs = 0; inode_read_at(dir->inode, &e, sizeof e, ofs) == sizeof e; ofs += sizeof e)
+		if (!index_add(index, &e, ofs))
+		{
+			dir_index_destroy(index);
+			return NULL;
+		}
+
+	inode_set_dir_index(dir->inode, index);
+	return index;
+}
+
 /* Searches DIR for a file with the given NAME.
  * If successful, returns true, sets *EP to the directory entry
  * if EP is non-null, and sets *OFSP to the byte offset of the
  * directory entry if OFSP is non-null.
- * otherwise, returns false and ignores EP and OFSP. */
+ * otherwise, returns false and ignores EP and OFSP.
+ * The caller must hold DIR's directory lock. */
 static bool
 lookup(const struct dir *dir, const char *name, struct dir_entry *ep, off_t *ofsp)
 {
+	struct dir_index *index;
 	struct dir_entry e;
 	size_t ofs;
 
 	ASSERT(dir != NULL);
 	ASSERT(name != NULL);
 
+	index = dir_index_get(dir);
+	if (index != NULL)
+	{
+		struct dir_slot *slot = index_find(index, name);
+		if (slot == NULL)
+			return false;
+		if (ep != NULL)
+		{
+			ep->inode_sector = slot->inode_sector;
+			strlcpy(ep->name, slot->name, sizeof ep->name);
+			ep->in_use = true;
+		}
+		if (ofsp != NULL)
+			*ofsp = slot->ofs;
+		return true;
+	}
+
 	for (ofs = 0; inode_read_at(dir->inode, &e, sizeof e, ofs) == sizeof e; ofs += sizeof e)
 	{
 		if (e.in_use && !strcmp(name, e.name))
@@ -123,14 +274,19 @@ lookup(const struct dir *dir, const char *name, struct dir_entry *ep, off_t *ofs
 bool dir_lookup(const struct dir *dir, const char *name, struct inode **inode)
 {
 	struct dir_entry e;
+	disk_sector_t sector;
 
 	ASSERT(dir != NULL);
 	ASSERT(name != NULL);
 
-	if (lookup(dir, name, &e, NULL))
-		*inode = inode_open(e.inode_sector);
-	else
-		*inode = NULL;
+	inode_dir_lock(dir->inode);
+	if (!dcache_lookup(dir->inode, name, &sector))
+	{
+		sector = lookup(dir, name, &e, NULL) ? e.inode_sector : DCACHE_NEGATIVE;
+		dcache_insert(dir->inode, name, sector);
+	}
+	*inode = sector != DCACHE_NEGATIVE ? inode_open(sector) : NULL;
+	inode_dir_unlock(dir->inode);
 
 	if (!strcmp(name, "."))
 		*inode = dir_get_inode(dir);
@@ -150,6 +306,8 @@ bool dir_add(struct dir *dir, const char *name, disk_sector_t inode_sector)
 	// printf("[DEBUG][dir_add]name: %s\n", name);
 	// printf("[DEBUG][dir_add]inode_sector: %d\n", inode_sector);
 
+	struct dir_index *index;
+	struct dir_slot *slot = NULL;
 	struct dir_entry e;
 	off_t ofs;
 	bool success = false;
@@ -161,6 +319,8 @@ bool dir_add(struct dir *dir, const char *name, disk_sector_t inode_sector)
 	if (*name == '\0' || strlen(name) > NAME_MAX)
 		return false;
 
+	inode_dir_lock(dir->inode);
+
 	/* Check that NAME is not in use. */
 	if (lookup(dir, name, NULL, NULL))
 		goto done;
@@ -171,18 +331,52 @@ bool dir_add(struct dir *dir, const char *name, disk_sector_t inode_sector)
 
 	 * inode_read_at() will only return a short read at end of file.
 	 * Otherwise, we'd need to verify that we didn't get a short
-	 * read due to something intermittent such as low memory. */
-	for (ofs = 0; inode_read_at(dir->inode, &e, sizeof e, ofs) == sizeof e; ofs += sizeof e)
-		if (!e.in_use)
-			break;
+	 * read due to something intermittent such as low memory.
+	 * With an index the free slot is taken from its free list. */
+	index = dir_index_get(dir);
+	if (index != NULL)
+	{
+		if (!list_empty(&index->free_slots))
+		{
+			slot = list_entry(list_front(&index->free_slots), struct dir_slot, list_elem);
+			ofs = slot->ofs;
+		}
+		else
+			ofs = index->end;
+	}
+	else
+		for (ofs = 0; inode_read_at(dir->inode, &e, sizeof e, ofs) == sizeof e; ofs += sizeof e)
+			if (!e.in_use)
+				break;
 
 	/* Write slot. */
 	e.in_use = true;
 	strlcpy(e.name, name, sizeof e.name);
 	e.inode_sector = inode_sector;
 	success = inode_write_at(dir->inode, &e, sizeof e, ofs) == sizeof e;
+	if (success)
+		dcache_invalidate(dir->inode, name);
+
+	/* Record it in the index.  If that runs out of memory, drop the
+	 * index; the next lookup rebuilds it from disk. */
+	if (success && index != NULL)
+	{
+		if (slot != NULL)
+		{
+			list_remove(&slot->list_elem);
+			slot->inode_sector = inode_sector;
+			strlcpy(slot->name, name, sizeof slot->name);
+			hash_insert(&index->names, &slot->hash_elem);
+		}
+		else if (!index_add(index, &e, ofs))
+		{
+			inode_set_dir_index(dir->inode, NULL);
+			dir_index_destroy(index);
+		}
+	}
 
 done:
+	inode_dir_unlock(dir->inode);
 	return success;
 }
 
@@ -191,6 +385,7 @@ done:
  * which occurs only if there is no file with the given NAME. */
 bool dir_remove(struct dir *dir, const char *name)
 {
+	struct dir_index *index;
 	struct dir_entry e;
 	struct inode *inode = NULL;
 	bool success = false;
@@ -199,6 +394,8 @@ bool dir_remove(struct dir *dir, const char *name)
 	ASSERT(dir != NULL);
 	ASSERT(name != NULL);
 
+	inode_dir_lock(dir->inode);
+
 	/* Find directory entry. */
 	if (!lookup(dir, name, &e, &ofs))
 		goto done;
@@ -212,13 +409,27 @@ bool dir_remove(struct dir *dir, const char *name)
 	e.in_use = false;
 	if (inode_write_at(dir->inode, &e, sizeof e, ofs) != sizeof e)
 		goto done;
+	dcache_invalidate(dir->inode, name);
+
+	/* Move its slot to the index's free list. */
+	index = inode_get_dir_index(dir->inode);
+	if (index != NULL)
+	{
+		struct dir_slot *slot = index_find(index, name);
+		hash_delete(&index->names, &slot->hash_elem);
+		list_push_back(&index->free_slots, &slot->list_elem);
+	}
 
-	/* Remove inode. */
+	/* Remove inode.  A removed directory's sector may be reused, so
+	 * forget the names cached under it. */
 	inode_remove(inode);
+	if (inode_is_dir(inode))
+		dcache_purge(inode);
 
 	success = true;
 
 done:
+	inode_dir_unlock(dir->inode);
 	inode_close(inode);
 
 	return success;
@@ -1,4 +1,5 @@
 #include "filesys/fat.h"
+#include <bitmap.h>
 #include "devices/disk.h"
 #include "filesys/filesys.h"
 #include "threads/malloc.h"
@@ -10,7 +11,7 @@
 struct fat_boot
 {
 	unsigned int magic;				  // overflow 감지
-	unsigned int sectors_per_cluster; // cluster 1개가 차지하는 sector 수 -> 1로 고정
+	unsigned int sectors_per_cluster; // cluster 1개가 차지하는 sector 수 -> format할 때 결정
 	unsigned int total_sectors;		  // disk의 모든 sector 수
 	unsigned int fat_start;			  // fat이 시작하는 sector number
 	unsigned int fat_sectors;		  // fat이 차지하는 sector 수
@@ -22,14 +23,38 @@ struct fat_fs
 {
 	struct fat_boot bs;		  // filesystem 정보
 	unsigned int *fat;		  // fat
-	unsigned int fat_length;  // fat의 길이 -> entry 개수
+	unsigned int fat_length;  // fat의 길이 -> entry 개수 (= data 영역의 cluster 수)
 	disk_sector_t data_start; // data block이 시작되는 sector number
-	cluster_t last_clst;	  // 마지막 clust?
-	struct lock write_lock;	  // 쓰기 lock
+	cluster_t last_clst;	  // 마지막으로 할당한 cluster -> 다음 빈 cluster 탐색의 시작점 (next-fit)
+	struct bitmap *used_map;  // cluster별 사용 여부, bit i = cluster i
+	struct bitmap *loaded_map; // FAT sector별로 disk에서 읽어왔는지 여부
+	struct bitmap *dirty_map; // FAT sector별로 disk에 다시 써야 하는지 여부
+	bool boot_dirty;		  // boot sector를 disk에 다시 써야 하는지 여부
+	struct lock write_lock;	  // FAT을 수정하는 작업(chain 생성/삭제, fat_put)을 serialize
+	struct lock load_lock;	  // FAT sector를 disk에서 읽는 작업을 serialize
 };
 
+/* FAT sector 하나에 들어가는 entry 수와, cluster CLST의 entry가 들어 있는
+ * FAT sector의 index (fat_start 기준) */
+#define FAT_PER_SECTOR (DISK_SECTOR_SIZE / sizeof(cluster_t))
+#define FAT_SECTOR(CLST) (((CLST)-1) / FAT_PER_SECTOR)
+
+/* FAT entry의 최상위 bit: 그 cluster가 hole, 즉 chain에는 있지만 아직 쓴 적이
+ * 없어서 disk 내용과 관계없이 0으로 읽어야 하는 cluster임을 표시
+ * 나머지 bit는 그대로 다음 cluster 번호 */
+#define FAT_HOLE 0x80000000
+
 static struct fat_fs *fat_fs;
 
+unsigned int fat_format_sectors_per_cluster = SECTORS_PER_CLUSTER;
+
+static void fat_set(cluster_t clst, cluster_t val);
+static void fat_setup(bool loaded);
+static void fat_load_sector(size_t idx);
+static void fat_write_sector(size_t idx);
+static size_t fat_scan(size_t start, size_t cnt);
+static cluster_t fat_alloc(void);
+
 void fat_boot_create(void);
 void fat_fs_init(void);
 
@@ -38,6 +63,8 @@ void fat_init(void)
 	fat_fs = calloc(1, sizeof(struct fat_fs));
 	if (fat_fs == NULL)
 		PANIC("FAT init failed");
+	lock_init(&fat_fs->write_lock);
+	lock_init(&fat_fs->load_lock);
 
 	// Read boot sector from the disk
 	unsigned int *bounce = malloc(DISK_SECTOR_SIZE);
@@ -53,74 +80,57 @@ void fat_init(void)
 	fat_fs_init();
 }
 
+/* FAT은 여기서 읽지 않고, 각 FAT sector를 처음 접근할 때 fat_load_sector()로
+ * 읽는다.  큰 disk에서도 boot 시간이 FAT 크기에 비례하지 않게 하기 위함
+ * 방금 format한 경우에는 FAT이 이미 메모리에 있으므로 그대로 쓴다. */
 void fat_open(void)
 {
+	if (fat_fs->fat != NULL)
+		return;
+
 	fat_fs->fat = calloc(fat_fs->fat_length, sizeof(cluster_t));
 	if (fat_fs->fat == NULL)
 		PANIC("FAT load failed");
-
-	// Load FAT directly from the disk
-	uint8_t *buffer = (uint8_t *)fat_fs->fat;
-	off_t bytes_read = 0;
-	off_t bytes_left = sizeof(fat_fs->fat);
-	const off_t fat_size_in_bytes = fat_fs->fat_length * sizeof(cluster_t);
-	for (unsigned i = 0; i < fat_fs->bs.fat_sectors; i++)
-	{
-		bytes_left = fat_size_in_bytes - bytes_read;
-		if (bytes_left >= DISK_SECTOR_SIZE)
-		{
-			disk_read(filesys_disk, fat_fs->bs.fat_start + i,
-					  buffer + bytes_read);
-			bytes_read += DISK_SECTOR_SIZE;
-		}
-		else
-		{
-			uint8_t *bounce = malloc(DISK_SECTOR_SIZE);
-			if (bounce == NULL)
-				PANIC("FAT load failed");
-			disk_read(filesys_disk, fat_fs->bs.fat_start + i, bounce);
-			memcpy(buffer + bytes_read, bounce, bytes_left);
-			bytes_read += bytes_left;
-			free(bounce);
-		}
-	}
+	fat_setup(false);
 }
 
 void fat_close(void)
 {
+	fat_sync();
+}
+
+/* 변경된 boot sector와 FAT sector만 disk에 write
+ * FAT을 수정하는 작업과 겹치지 않도록 write_lock을 잡고 진행 */
+void fat_sync(void)
+{
+	size_t i;
+
+	if (fat_fs == NULL || fat_fs->dirty_map == NULL)
+		return;
+
+	lock_acquire(&fat_fs->write_lock);
+
 	// Write FAT boot sector
-	uint8_t *bounce = calloc(1, DISK_SECTOR_SIZE);
-	if (bounce == NULL)
-		PANIC("FAT close failed");
-	memcpy(bounce, &fat_fs->bs, sizeof(fat_fs->bs));
-	disk_write(filesys_disk, FAT_BOOT_SECTOR, bounce);
-	free(bounce);
+	if (fat_fs->boot_dirty)
+	{
+		uint8_t *bounce = calloc(1, DISK_SECTOR_SIZE);
+		if (bounce == NULL)
+			PANIC("FAT sync failed");
+		memcpy(bounce, &fat_fs->bs, sizeof(fat_fs->bs));
+		disk_write(filesys_disk, FAT_BOOT_SECTOR, bounce);
+		free(bounce);
+		fat_fs->boot_dirty = false;
+	}
 
-	// Write FAT directly to the disk
-	uint8_t *buffer = (uint8_t *)fat_fs->fat;
-	off_t bytes_wrote = 0;
-	off_t bytes_left = sizeof(fat_fs->fat);
-	const off_t fat_size_in_bytes = fat_fs->fat_length * sizeof(cluster_t);
-	for (unsigned i = 0; i < fat_fs->bs.fat_sectors; i++)
+	// Write dirty FAT sectors in order
+	for (i = bitmap_scan(fat_fs->dirty_map, 0, 1, true); i != BITMAP_ERROR;
+		 i = bitmap_scan(fat_fs->dirty_map, i + 1, 1, true))
 	{
-		bytes_left = fat_size_in_bytes - bytes_wrote;
-		if (bytes_left >= DISK_SECTOR_SIZE)
-		{
-			disk_write(filesys_disk, fat_fs->bs.fat_start + i,
-					   buffer + bytes_wrote);
-			bytes_wrote += DISK_SECTOR_SIZE;
-		}
-		else
-		{
-			bounce = calloc(1, DISK_SECTOR_SIZE);
-			if (bounce == NULL)
-				PANIC("FAT close failed");
-			memcpy(bounce, buffer + bytes_wrote, bytes_left);
-			disk_write(filesys_disk, fat_fs->bs.fat_start + i, bounce);
-			bytes_wrote += bytes_left;
-			free(bounce);
-		}
+		fat_write_sector(i);
+		bitmap_reset(fat_fs->dirty_map, i);
 	}
+
+	lock_release(&fat_fs->write_lock);
 }
 
 void fat_create(void)
@@ -130,9 +140,11 @@ void fat_create(void)
 	fat_fs_init();
 
 	// Create FAT table
+	free(fat_fs->fat);
 	fat_fs->fat = calloc(fat_fs->fat_length, sizeof(cluster_t));
 	if (fat_fs->fat == NULL)
 		PANIC("FAT creation failed");
+	fat_setup(true);
 
 	// Set up ROOT_DIR_CLST
 	fat_put(ROOT_DIR_CLUSTER, EOChain);
@@ -147,11 +159,17 @@ void fat_create(void)
 
 void fat_boot_create(void)
 {
+	unsigned int spc = fat_format_sectors_per_cluster;
+	if (spc == 0 || spc > MAX_SECTORS_PER_CLUSTER || (spc & (spc - 1)) != 0)
+		PANIC("sectors per cluster must be a power of 2 up to %d, not %u",
+			  MAX_SECTORS_PER_CLUSTER, spc);
+
 	unsigned int fat_sectors =
-		(disk_size(filesys_disk) - 1) / (DISK_SECTOR_SIZE / sizeof(cluster_t) * SECTORS_PER_CLUSTER + 1) + 1;
+		(disk_size(filesys_disk) - 1) / (DISK_SECTOR_SIZE / sizeof(cluster_t) * spc + 1) + 1;
+	fat_fs->boot_dirty = true;
 	fat_fs->bs = (struct fat_boot){
 		.magic = FAT_MAGIC,
-		.sectors_per_cluster = SECTORS_PER_CLUSTER,
+		.sectors_per_cluster = spc,
 		.total_sectors = disk_size(filesys_disk),
 		.fat_start = 1,
 		.fat_sectors = fat_sectors,
@@ -161,7 +179,7 @@ void fat_boot_create(void)
 
 void fat_fs_init(void)
 {
-	fat_fs->fat_length = disk_size(filesys_disk) - 1 - fat_fs->bs.fat_sectors;
+	fat_fs->fat_length = (disk_size(filesys_disk) - 1 - fat_fs->bs.fat_sectors) / fat_fs->bs.sectors_per_cluster;
 	fat_fs->data_start = fat_fs->bs.fat_start + fat_fs->bs.fat_sectors;
 }
 
@@ -169,44 +187,230 @@ void fat_fs_init(void)
 /* FAT handling                                                               */
 /*----------------------------------------------------------------------------*/
 
+/* FAT의 in-memory 상태(used_map, loaded_map, dirty_map)를 만든다.
+ * LOADED이면 메모리의 FAT 전체(format 직후의 빈 FAT)를 그대로 쓰고, disk에
+ * 남아 있는 이전 FAT을 덮어쓰도록 모든 FAT sector를 dirty로 표시한다.
+ * 아니면 아직 읽지 않은 FAT sector의 cluster는 빈 cluster인지 알 수 없으므로
+ * used_map에 사용 중으로 두고, fat_load_sector()에서 실제 값으로 고친다.
+ * cluster 0과 root directory cluster는 할당 대상이 아니므로 항상 사용 중 */
+static void
+fat_setup(bool loaded)
+{
+	if (fat_fs->used_map != NULL)
+		bitmap_destroy(fat_fs->used_map);
+	if (fat_fs->loaded_map != NULL)
+		bitmap_destroy(fat_fs->loaded_map);
+	if (fat_fs->dirty_map != NULL)
+		bitmap_destroy(fat_fs->dirty_map);
+	fat_fs->used_map = bitmap_create(fat_fs->fat_length);
+	fat_fs->loaded_map = bitmap_create(fat_fs->bs.fat_sectors);
+	fat_fs->dirty_map = bitmap_create(fat_fs->bs.fat_sectors);
+	if (fat_fs->used_map == NULL || fat_fs->loaded_map == NULL || fat_fs->dirty_map == NULL)
+		PANIC("FAT map creation failed");
+
+	bitmap_set_all(fat_fs->used_map, !loaded);
+	bitmap_set_all(fat_fs->loaded_map, loaded);
+	bitmap_set_all(fat_fs->dirty_map, loaded);
+	bitmap_set_multiple(fat_fs->used_map, 0, 2, true);
+	fat_fs->last_clst = ROOT_DIR_CLUSTER;
+}
+
+/* IDX번째 FAT sector를 disk에서 읽어 FAT에 채우고, 그 sector에 들어 있는
+ * cluster들의 used_map bit를 실제 값으로 설정한다.
+ * 이미 읽은 sector이면 아무것도 하지 않는다.
+ * write_lock을 잡은 채로 불릴 수 있으므로 load_lock만 사용 */
+static void
+fat_load_sector(size_t idx)
+{
+	lock_acquire(&fat_fs->load_lock);
+	if (!bitmap_test(fat_fs->loaded_map, idx))
+	{
+		const size_t fat_size_in_bytes = fat_fs->fat_length * sizeof(cluster_t);
+		size_t ofs = idx * DISK_SECTOR_SIZE;
+		size_t bytes = ofs < fat_size_in_bytes ? fat_size_in_bytes - ofs : 0;
+		uint8_t *buffer = (uint8_t *)fat_fs->fat;
+
+		if (bytes >= DISK_SECTOR_SIZE)
+			disk_read(filesys_disk, fat_fs->bs.fat_start + idx, buffer + ofs);
+		else
+		{
+			uint8_t *bounce = malloc(DISK_SECTOR_SIZE);
+			if (bounce == NULL)
+				PANIC("FAT load failed");
+			disk_read(filesys_disk, fat_fs->bs.fat_start + idx, bounce);
+			memcpy(buffer + ofs, bounce, bytes);
+			free(bounce);
+		}
+
+		cluster_t clst = idx * FAT_PER_SECTOR + 1;
+		cluster_t end = clst + FAT_PER_SECTOR;
+		if (end > fat_fs->fat_length)
+			end = fat_fs->fat_length;
+		for (; clst < end; clst++)
+			if (clst >= 2)
+				bitmap_set(fat_fs->used_map, clst, fat_fs->fat[clst - 1] != 0);
+
+		/* FAT 내용을 채운 뒤에 표시해야 lock 없이 loaded_map을 보는
+		 * fat_get()이 읽기 전의 값을 보지 않는다. */
+		bitmap_mark(fat_fs->loaded_map, idx);
+	}
+	lock_release(&fat_fs->load_lock);
+}
+
+/* IDX번째 FAT sector를 disk에 write.  The caller must hold the FAT lock. */
+static void
+fat_write_sector(size_t idx)
+{
+	const size_t fat_size_in_bytes = fat_fs->fat_length * sizeof(cluster_t);
+	size_t ofs = idx * DISK_SECTOR_SIZE;
+	size_t bytes = ofs < fat_size_in_bytes ? fat_size_in_bytes - ofs : 0;
+	uint8_t *buffer = (uint8_t *)fat_fs->fat;
+
+	if (bytes >= DISK_SECTOR_SIZE)
+		disk_write(filesys_disk, fat_fs->bs.fat_start + idx, buffer + ofs);
+	else
+	{
+		uint8_t *bounce = calloc(1, DISK_SECTOR_SIZE);
+		if (bounce == NULL)
+			PANIC("FAT sync failed");
+		memcpy(bounce, buffer + ofs, bytes);
+		disk_write(filesys_disk, fat_fs->bs.fat_start + idx, bounce);
+		free(bounce);
+	}
+}
+
+/* used_map에서 START부터 (끝까지 없으면 처음부터) 연속된 빈 cluster CNT개를
+ * 찾아 첫 cluster를 return, 없으면 BITMAP_ERROR
+ * 아직 읽지 않은 FAT sector의 cluster는 사용 중으로 표시되어 있으므로, 못
+ * 찾으면 START 이후의 읽지 않은 FAT sector를 하나 더 읽고 다시 찾는다.
+ * The caller must hold the FAT lock. */
+static size_t
+fat_scan(size_t start, size_t cnt)
+{
+	size_t sec = start >= 1 && start <= fat_fs->fat_length ? FAT_SECTOR(start) : 0;
+
+	for (;;)
+	{
+		size_t i = bitmap_scan(fat_fs->used_map, start, cnt, false);
+		if (i == BITMAP_ERROR)
+			i = bitmap_scan(fat_fs->used_map, 0, cnt, false);
+		if (i != BITMAP_ERROR)
+			return i;
+
+		sec = bitmap_scan(fat_fs->loaded_map, sec, 1, false);
+		if (sec == BITMAP_ERROR)
+			sec = bitmap_scan(fat_fs->loaded_map, 0, 1, false);
+		if (sec == BITMAP_ERROR)
+			return BITMAP_ERROR;
+		fat_load_sector(sec);
+	}
+}
+
+/* 빈 cluster 하나를 찾아서 return, 없으면 0
+ * next-fit: 마지막으로 할당한 cluster 다음부터 찾고, 끝까지 없으면 처음부터 다시 탐색
+ * The caller must hold the FAT lock. */
+static cluster_t
+fat_alloc(void)
+{
+	size_t i = fat_scan(fat_fs->last_clst + 1, 1);
+
+	if (i == BITMAP_ERROR)
+		return 0;
+
+	fat_fs->last_clst = i;
+	return i;
+}
+
 /* Add a cluster to the chain.
  * If CLST is 0, start a new chain.
- * Returns 0 if fails to allocate a new cluster. */
+ * Returns 0 if fails to allocate a new cluster.
+ * CLST는 chain의 마지막 cluster여야 한다. chain을 따라가며 끝을 찾지
+ * 않으므로, caller(inode의 cluster map 등)가 알고 있는 끝을 넘긴다. */
 cluster_t
 fat_create_chain(cluster_t clst)
 {
-	/* FAT에서 empty cluster 탐색 */
-	int i;
-	for (i = 2; i < fat_fs->fat_length && fat_get(i) > 0; i++)
-		;
+	lock_acquire(&fat_fs->write_lock);
+
+	/* used_map에서 empty cluster 탐색 */
+	cluster_t i = fat_alloc();
 
 	/* empty cluster가 없으면 */
-	if (i >= fat_fs->fat_length)
+	if (i == 0)
+	{
+		lock_release(&fat_fs->write_lock);
 		return 0;
+	}
 
 	/* empty cluster에 새로운 cluster 생성 */
-	fat_put(i, EOChain);
-
-	/* 새로운 cluster chain일 때 */
-	if (clst == 0)
-		return i;
+	fat_set(i, EOChain);
 
 	/* 기존 cluster chain의 마지막에 추가할 때 */
-	cluster_t temp_c;
-	for (temp_c = clst; fat_get(temp_c) != EOChain; temp_c = fat_get(temp_c))
-		;
-	fat_put(temp_c, i);
+	if (clst != 0)
+	{
+		ASSERT(fat_get(clst) == EOChain);
+		fat_set(clst, i);
+	}
 
+	lock_release(&fat_fs->write_lock);
 	return i;
 }
 
+/* HINT 다음부터 연속된 빈 cluster CNT개를 찾아 예약하고, 예약한 개수를
+ * return (첫 cluster는 *START), 하나도 없으면 0
+ * 길이 CNT인 run이 없으면 CNT를 절반씩 줄여가며 다시 찾는다.
+ * 예약된 cluster는 used_map에만 사용 중으로 표시되고 FAT에는 0으로 남으므로
+ * fat_chain_append()로 chain에 연결하거나 fat_unreserve()로 반환해야 한다.
+ * HINT가 0이면 next-fit 위치부터 찾는다. */
+size_t
+fat_reserve(cluster_t hint, size_t cnt, cluster_t *start)
+{
+	lock_acquire(&fat_fs->write_lock);
+
+	if (hint == 0)
+		hint = fat_fs->last_clst;
+	for (; cnt > 0; cnt /= 2)
+	{
+		size_t i = fat_scan(hint + 1, cnt);
+		if (i != BITMAP_ERROR)
+		{
+			bitmap_set_multiple(fat_fs->used_map, i, cnt, true);
+			fat_fs->last_clst = i + cnt - 1;
+			*start = i;
+			break;
+		}
+	}
+
+	lock_release(&fat_fs->write_lock);
+	return cnt;
+}
+
+/* fat_reserve()로 예약한 START부터 CNT개의 cluster를 반환 */
+void fat_unreserve(cluster_t start, size_t cnt)
+{
+	lock_acquire(&fat_fs->write_lock);
+	bitmap_set_multiple(fat_fs->used_map, start, cnt, false);
+	lock_release(&fat_fs->write_lock);
+}
+
+/* 예약된 cluster CLST를 chain의 마지막 cluster TAIL 뒤에 연결 */
+void fat_chain_append(cluster_t tail, cluster_t clst)
+{
+	lock_acquire(&fat_fs->write_lock);
+	ASSERT(fat_get(tail) == EOChain);
+	fat_set(clst, EOChain);
+	fat_set(tail, clst);
+	lock_release(&fat_fs->write_lock);
+}
+
 /* Remove the chain of clusters starting from CLST.
  * If PCLST is 0, assume CLST as the start of the chain. */
 void fat_remove_chain(cluster_t clst, cluster_t pclst)
 {
+	lock_acquire(&fat_fs->write_lock);
+
 	/* pcluster가 입력됬으면 pcluster를 chain으로 끝으로 만듬 */
 	if (pclst)
-		fat_put(pclst, EOChain);
+		fat_set(pclst, EOChain);
 
 	/* clst부터 순회하면서 FAT에서 할당 해제 */
 	cluster_t temp_c = clst;
@@ -214,39 +418,92 @@ void fat_remove_chain(cluster_t clst, cluster_t pclst)
 	for (; fat_get(temp_c) != EOChain; temp_c = next_c)
 	{
 		next_c = fat_get(temp_c);
-		fat_put(temp_c, 0);
+		fat_set(temp_c, 0);
 	}
 
-	fat_put(temp_c, 0);
+	fat_set(temp_c, 0);
+
+	lock_release(&fat_fs->write_lock);
 }
 
 /* Update a value in the FAT table. */
 void fat_put(cluster_t clst, cluster_t val)
 {
-	if (cluster_to_sector(clst - 1) >= disk_size(filesys_disk))
+	lock_acquire(&fat_fs->write_lock);
+	fat_set(clst, val);
+	lock_release(&fat_fs->write_lock);
+}
+
+/* Updates a value in the FAT table and marks its FAT sector dirty,
+ * so fat_sync() writes back only the sectors that changed.  The
+ * cluster keeps its hole mark unless VAL frees it.  The caller
+ * must hold the FAT lock. */
+static void
+fat_set(cluster_t clst, cluster_t val)
+{
+	if (clst == 0 || clst > fat_fs->fat_length)
 		return;
 
+	/* 읽기 전의 sector에 쓰면 나중에 읽을 때 덮어써지므로 먼저 읽는다. */
+	if (!bitmap_test(fat_fs->loaded_map, FAT_SECTOR(clst)))
+		fat_load_sector(FAT_SECTOR(clst));
+	if (val != 0)
+		val |= fat_fs->fat[clst - 1] & FAT_HOLE;
 	fat_fs->fat[clst - 1] = val;
+	bitmap_mark(fat_fs->dirty_map, FAT_SECTOR(clst));
+	if (clst >= 2 && clst < fat_fs->fat_length)
+		bitmap_set(fat_fs->used_map, clst, val != 0);
 }
 
 /* Fetch a value in the FAT table. */
 cluster_t
 fat_get(cluster_t clst)
 {
-	return fat_fs->fat[clst - 1];
+	if (!bitmap_test(fat_fs->loaded_map, FAT_SECTOR(clst)))
+		fat_load_sector(FAT_SECTOR(clst));
+	return fat_fs->fat[clst - 1] & ~FAT_HOLE;
+}
+
+/* Returns true if CLST is a hole, a cluster in a chain that has
+ * never been written and reads as zeros. */
+bool fat_is_hole(cluster_t clst)
+{
+	if (!bitmap_test(fat_fs->loaded_map, FAT_SECTOR(clst)))
+		fat_load_sector(FAT_SECTOR(clst));
+	return (fat_fs->fat[clst - 1] & FAT_HOLE) != 0;
+}
+
+/* Marks CLST, which must be in a chain, as a hole if HOLE is true,
+ * or as holding data otherwise. */
+void fat_set_hole(cluster_t clst, bool hole)
+{
+	lock_acquire(&fat_fs->write_lock);
+	cluster_t val = fat_get(clst);
+	ASSERT(val != 0);
+	fat_fs->fat[clst - 1] = hole ? val | FAT_HOLE : val;
+	bitmap_mark(fat_fs->dirty_map, FAT_SECTOR(clst));
+	lock_release(&fat_fs->write_lock);
+}
+
+/* Returns the number of sectors in a cluster. */
+unsigned int
+fat_sectors_per_cluster(void)
+{
+	return fat_fs->bs.sectors_per_cluster;
 }
 
-/* Covert a cluster # to a sector number. */
+/* Covert a cluster # to the number of its first sector. */
 disk_sector_t
 cluster_to_sector(cluster_t clst)
 {
-	return clst + fat_fs->data_start;
+	return fat_fs->data_start + clst * fat_fs->bs.sectors_per_cluster;
 }
 
+/* Returns the cluster that contains SECTOR. */
 cluster_t
 sector_to_cluster(disk_sector_t sector)
 {
-	cluster_t clst = sector - fat_fs->data_start;
+	cluster_t clst = (sector - fat_fs->data_start) / fat_fs->bs.sectors_per_cluster;
 
 	if (clst < 2)
 		return 0;
@@ -259,10 +516,10 @@ void print_fat(int start, int end)
 	printf("\n=========================FAT====================================================================================\n");
 	for (int i = start; i < end; i++)
 	{
-		if (fat_fs->fat[i] == EOChain)
+		if (fat_get(i + 1) == EOChain)
 			printf(" [%3d|EOC] ", i + 1);
 		else
-			printf(" [%3d|%3d] ", i + 1, fat_fs->fat[i]);
+			printf(" [%3d|%3d] ", i + 1, fat_get(i + 1));
 		if (i % 5 == 4)
 			printf("\n");
 	}
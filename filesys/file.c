@@ -1,8 +1,17 @@
 #include "filesys/file.h"
 #include <debug.h>
+#include <round.h>
 #include "filesys/inode.h"
 #include "threads/malloc.h"
 
+/* Read-ahead window limits, in bytes.  The window starts at
+ * RA_MIN on the first sequential read, doubles on each further
+ * one up to RA_MAX, and drops to zero on a random read. */
+#define RA_MIN (4 * DISK_SECTOR_SIZE)
+#define RA_MAX (32 * DISK_SECTOR_SIZE)
+
+static void file_readahead(struct file *, off_t ofs, off_t size);
+
 /* Opens a file for the given INODE, of which it takes ownership,
  * and returns the new file.  Returns a null pointer if an
  * allocation fails or if INODE is null. */
@@ -76,10 +85,49 @@ file_get_inode(struct file *file)
 off_t file_read(struct file *file, void *buffer, off_t size)
 {
 	off_t bytes_read = inode_read_at(file->inode, buffer, size, file->pos);
+	file_readahead(file, file->pos, bytes_read);
 	file->pos += bytes_read;
 	return bytes_read;
 }
 
+/* Updates FILE's read-ahead state after a read of SIZE bytes at
+ * OFS.  If the read continued where the last one ended, grows the
+ * window and queues whatever part of it has not been read ahead
+ * yet; otherwise collapses the window. */
+static void file_readahead(struct file *file, off_t ofs, off_t size)
+{
+	off_t start, end;
+
+	if (size <= 0)
+		return;
+
+	if (ofs == file->ra_next)
+	{
+		if (file->ra_window == 0)
+			file->ra_window = RA_MIN;
+		else if (file->ra_window < RA_MAX)
+			file->ra_window *= 2;
+	}
+	else
+	{
+		file->ra_window = 0;
+		file->ra_end = 0;
+	}
+	file->ra_next = ofs + size;
+	if (file->ra_window == 0)
+		return;
+
+	/* Queue whole sectors only, so that a run of small reads
+	 * queues each sector once. */
+	start = file->ra_next > file->ra_end ? file->ra_next : file->ra_end;
+	end = ROUND_UP(file->ra_next + file->ra_window, DISK_SECTOR_SIZE);
+	if (start < end)
+	{
+		inode_readahead(file->inode, start, end);
+		file->ra_end = end;
+	}
+}
+
 /* Reads SIZE bytes from FILE into BUFFER,
  * starting at offset FILE_OFS in the file.
  * Returns the number of bytes actually read,
@@ -142,6 +190,21 @@ void file_allow_write(struct file *file)
 	}
 }
 
+/* Reserves disk space for the first END bytes of FILE without
+ * changing its length.  Returns false if the disk fills up. */
+bool file_allocate(struct file *file, off_t end)
+{
+	ASSERT(file != NULL);
+	return inode_allocate(file->inode, end);
+}
+
+/* Writes FILE's dirty data and its inode to disk. */
+void file_sync(struct file *file)
+{
+	ASSERT(file != NULL);
+	inode_sync(file->inode);
+}
+
 /* Returns the size of FILE in bytes. */
 off_t file_length(struct file *file)
 {
@@ -165,3 +228,22 @@ off_t file_tell(struct file *file)
 	ASSERT(file != NULL);
 	return file->pos;
 }
+
+/* Returns the offset of the first byte at or after POS in FILE
+ * that holds data, or -1 if there is none before end of file. */
+off_t file_seek_data(struct file *file, off_t pos)
+{
+	ASSERT(file != NULL);
+	ASSERT(pos >= 0);
+	return inode_seek_data(file->inode, pos);
+}
+
+/* Returns the offset of the first byte at or after POS in FILE
+ * that lies in a hole, end of file counting as one, or -1 if POS
+ * is at or past end of file. */
+off_t file_seek_hole(struct file *file, off_t pos)
+{
+	ASSERT(file != NULL);
+	ASSERT(pos >= 0);
+	return inode_seek_hole(file->inode, pos);
+}
@@ -7,6 +7,8 @@
 #include "filesys/free-map.h"
 #include "filesys/fat.h"
 #include "filesys/inode.h"
+#include "filesys/page_cache.h"
+#include "filesys/dcache.h"
 #include "filesys/directory.h"
 #include "filesys/fsutil.h"
 #include "devices/disk.h"
@@ -26,6 +28,8 @@ void filesys_init(bool format)
 		PANIC("hd0:1 (hdb) not present, file system initialization failed");
 
 	inode_init();
+	page_cache_init();
+	dcache_init();
 
 #ifdef EFILESYS
 	fat_init();
@@ -51,6 +55,8 @@ void filesys_init(bool format)
  * to disk. */
 void filesys_done(void)
 {
+	page_cache_flush();
+
 	/* Original FS */
 #ifdef EFILESYS
 	fat_close();
@@ -6,7 +6,9 @@
 #include "filesys/directory.h"
 #include "filesys/file.h"
 #include "filesys/filesys.h"
+#include "filesys/inode.h"
 #include "devices/disk.h"
+#include "devices/timer.h"
 #include "threads/malloc.h"
 #include "threads/palloc.h"
 #include "threads/vaddr.h"
@@ -53,6 +55,21 @@ void fsutil_cat(char **argv)
 	file_close(file);
 }
 
+/* Prints the number of extents, that is, runs of consecutive
+ * clusters, that hold file ARGV[1]. */
+void fsutil_extents(char **argv)
+{
+	const char *file_name = argv[1];
+	struct file *file;
+
+	file = filesys_open(file_name);
+	if (file == NULL)
+		PANIC("%s: open failed", file_name);
+	printf("'%s': %d bytes in %zu extents\n", file_name, file_length(file),
+		   inode_extent_cnt(file_get_inode(file)));
+	file_close(file);
+}
+
 /* Deletes file ARGV[1]. */
 void fsutil_rm(char **argv)
 {
@@ -191,3 +208,81 @@ void fsutil_get(char **argv)
 	file_close(src);
 	free(buffer);
 }
+
+/* Sectors that fsutil_diskbench() moves per pass, and passes it
+ * makes for each transfer size. */
+#define BENCH_SECTORS 1024
+#define BENCH_PASSES 4
+
+static void print_throughput(const char *what, disk_sector_t cnt, int64_t ticks);
+
+/* Measures the throughput of the swap disk, or of the scratch disk
+ * if there is none, for transfers of 1, 8 and 64 sectors.  For
+ * each size it reads the start of the disk and writes the same
+ * data back, BENCH_PASSES times, so the disk's contents do not
+ * change, and prints the rate in MB/s. */
+void fsutil_diskbench(char **argv UNUSED)
+{
+	static const size_t sizes[] = {1, 8, 64};
+
+	struct disk *disk;
+	disk_sector_t total;
+	uint8_t *buffer;
+	size_t i;
+
+	disk = disk_get(1, 1);
+	if (disk == NULL)
+		disk = disk_get(1, 0);
+	if (disk == NULL)
+		PANIC("couldn't open swap or scratch disk (hd1:1 or hd1:0)");
+
+	total = disk_size(disk) < BENCH_SECTORS ? disk_size(disk) : BENCH_SECTORS;
+	total -= total % 64;
+	if (total == 0)
+		PANIC("disk too small to benchmark");
+
+	printf("Benchmarking %" PRDSNu " sectors...\n", total);
+	buffer = palloc_get_multiple(PAL_ASSERT, total * DISK_SECTOR_SIZE / PGSIZE);
+	for (i = 0; i < sizeof sizes / sizeof *sizes; i++)
+	{
+		size_t size = sizes[i];
+		int64_t start, read_ticks, write_ticks;
+		disk_sector_t sector;
+		int pass;
+
+		start = timer_ticks();
+		for (pass = 0; pass < BENCH_PASSES; pass++)
+			for (sector = 0; sector < total; sector += size)
+				disk_read_multiple(disk, sector, size, buffer + sector * DISK_SECTOR_SIZE);
+		read_ticks = timer_elapsed(start);
+
+		start = timer_ticks();
+		for (pass = 0; pass < BENCH_PASSES; pass++)
+			for (sector = 0; sector < total; sector += size)
+				disk_write_multiple(disk, sector, size, buffer + sector * DISK_SECTOR_SIZE);
+		write_ticks = timer_elapsed(start);
+
+		printf("%zu-sector transfers: ", size);
+		print_throughput("read", total, read_ticks);
+		printf(", ");
+		print_throughput("write", total, write_ticks);
+		printf("\n");
+	}
+	palloc_free_multiple(buffer, total * DISK_SECTOR_SIZE / PGSIZE);
+}
+
+/* Prints WHAT and the rate in MB/s at which fsutil_diskbench()
+ * moved CNT sectors BENCH_PASSES times in TICKS timer ticks. */
+static void print_throughput(const char *what, disk_sector_t cnt, int64_t ticks)
+{
+	long long bytes = (long long)cnt * BENCH_PASSES * DISK_SECTOR_SIZE;
+	long long kbps;
+
+	if (ticks == 0)
+	{
+		printf("%s too fast to time", what);
+		return;
+	}
+	kbps = bytes * TIMER_FREQ / 1024 / ticks;
+	printf("%s %lld.%02lld MB/s", what, kbps / 1024, kbps % 1024 * 100 / 1024);
+}
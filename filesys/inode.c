@@ -1,81 +1,372 @@
 #include "filesys/inode.h"
+#include <hash.h>
 #include <list.h>
 #include <debug.h>
+#include <stdio.h>
 #include <round.h>
 #include <string.h>
+#include "filesys/directory.h"
 #include "filesys/filesys.h"
 #include "filesys/free-map.h"
 #include "filesys/fat.h"
+#include "filesys/page_cache.h"
 #include "threads/malloc.h"
+#include "threads/synch.h"
 
 /* Identifies an inode. */
 #define INODE_MAGIC 0x494e4f44
 
+/* Clusters reserved at a time for a growing file, so that files
+ * growing side by side do not interleave cluster by cluster. */
+#define PREALLOC_CLUSTERS 16
+
+/* Largest file whose data is kept inline in its inode sector. */
+#define INLINE_MAX 488
+
 /* On-disk inode.
  * Must be exactly DISK_SECTOR_SIZE bytes long. */
 struct inode_disk
 {
-	disk_sector_t start;
+	disk_sector_t start; /* First data sector, unless inline. */
 	off_t length; /* File size in bytes. */
 	uint32_t is_dir;
 	uint32_t is_link;
+	uint32_t is_inline; /* Data in INLINE_DATA, no clusters? */
 	unsigned magic;		 /* Magic number. */
-	char link_name[492]; /* Not used. */
+	union
+	{
+		char link_name[INLINE_MAX];		/* Target of a symlink. */
+		uint8_t inline_data[INLINE_MAX]; /* Data of a small file. */
+	};
 };
 
-/* Returns the number of sectors to allocate for an inode SIZE
+/* Returns the number of bytes in a cluster. */
+static inline off_t
+cluster_bytes(void)
+{
+	return fat_sectors_per_cluster() * DISK_SECTOR_SIZE;
+}
+
+/* Returns the number of clusters to allocate for an inode SIZE
  * bytes long. */
 static inline size_t
-bytes_to_sectors(off_t size)
+bytes_to_clusters(off_t size)
 {
-	return DIV_ROUND_UP(size, DISK_SECTOR_SIZE);
+	return DIV_ROUND_UP(size, cluster_bytes());
 }
 
 /* In-memory inode. */
 struct inode
 {
-	struct list_elem elem; /* Element in inode list. */
+	struct hash_elem hash_elem; /* Element in inode table. */
+	struct list_elem lru_elem;	/* Element in closed_inodes, if closed. */
 	disk_sector_t sector;
 	int open_cnt;			/* Number of openers. */
+	bool loading;			/* DATA not read in yet. */
+	struct condition loaded; /* Signaled when LOADING becomes false. */
 	bool removed;			/* True if deleted, false otherwise. */
 	int deny_write_cnt;		/* 0: writes ok, >0: deny writes. */
+	struct rwlock rwlock;	/* Shared by readers, exclusive to writers. */
+	struct lock dir_lock;	/* Serializes access to a directory. */
+	struct dir_index *dir_index; /* Directory's name index, or NULL. */
 	struct inode_disk data; /* Inode content. */
+
+	/* Cluster map: the first MAP_CNT clusters of the chain, in
+	 * order, so that finding the cluster for an offset does not
+	 * walk the FAT.  Built lazily by inode_cluster(). */
+	struct lock map_lock;	/* Protects the three members below. */
+	cluster_t *map;			/* Cluster numbers, or NULL. */
+	size_t map_cnt;			/* Number of valid entries in MAP. */
+	size_t map_cap;			/* Number of entries allocated. */
+
+	/* Preallocation window: clusters reserved for this inode's
+	 * growth but not yet in its chain.  Returned on last close.
+	 * Protected by MAP_LOCK. */
+	cluster_t pa_start;		/* Next reserved cluster. */
+	size_t pa_cnt;			/* Number of reserved clusters left. */
 };
 
-/* Returns the disk sector that contains byte offset POS within
- * INODE.
- * Returns -1 if INODE does not contain data for a byte at offset
- * POS. */
-static disk_sector_t
-byte_to_sector(const struct inode *inode, off_t pos)
+static cluster_t inode_cluster(struct inode *, size_t idx, bool grow);
+static cluster_t inode_grow(struct inode *, cluster_t tail, size_t want);
+static void zero_cluster(cluster_t, disk_sector_t owner);
+
+/* Returns the cluster that contains byte offset POS within INODE,
+ * or 0 if POS lies past the end of INODE's cluster chain, where
+ * the file is one hole.
+ * GROW이면 file length와 관계없이 pos까지 진행하고, chain이 pos보다
+ * 짧으면 새로운 cluster를 할당해가면서 진행
+ * 이때 0은 chain이 POS에 닿기 전에 disk가 가득 찼다는 뜻 */
+static cluster_t
+byte_to_cluster(struct inode *inode, off_t pos, bool grow)
 {
 	ASSERT(inode != NULL);
 
-	cluster_t target = sector_to_cluster(inode->data.start);
+	return inode_cluster(inode, pos / cluster_bytes(), grow);
+}
+
+/* Returns the disk sector within CLST, the cluster returned by
+ * byte_to_cluster(), that contains byte offset POS. */
+static disk_sector_t
+byte_to_sector(cluster_t clst, off_t pos)
+{
+	return cluster_to_sector(clst) + pos % cluster_bytes() / DISK_SECTOR_SIZE;
+}
+
+/* Appends CLST to INODE's cluster map as entry IDX.  Does nothing
+ * if IDX does not directly follow the map or memory runs out; the
+ * map is only a cache. */
+static void
+map_append(struct inode *inode, size_t idx, cluster_t clst)
+{
+	if (idx != inode->map_cnt)
+		return;
+
+	if (inode->map_cnt == inode->map_cap)
+	{
+		size_t cap = inode->map_cap ? inode->map_cap * 2 : 16;
+		cluster_t *map = realloc(inode->map, cap * sizeof *map);
+		if (map == NULL)
+			return;
+		inode->map = map;
+		inode->map_cap = cap;
+	}
+	inode->map[inode->map_cnt++] = clst;
+}
+
+/* Returns the IDX'th cluster of INODE's chain, or 0 if the chain
+ * is shorter than that.  With GROW, extends the chain with hole
+ * clusters instead, returning 0 only if the disk fills up.
+ * Clusters already in the map cost O(1); others are found by
+ * walking the FAT from the last mapped cluster and are added to
+ * the map on the way. */
+static cluster_t
+inode_cluster(struct inode *inode, size_t idx, bool grow)
+{
+	cluster_t clst;
+	size_t i;
+
+	lock_acquire(&inode->map_lock);
+	if (idx < inode->map_cnt)
+	{
+		clst = inode->map[idx];
+		lock_release(&inode->map_lock);
+		return clst;
+	}
+
+	if (inode->map_cnt > 0)
+	{
+		i = inode->map_cnt - 1;
+		clst = inode->map[i];
+	}
+	else
+	{
+		/* data.start가 0이면 chain이 비어 있다. */
+		i = 0;
+		if (inode->data.start != 0)
+			clst = sector_to_cluster(inode->data.start);
+		else if (!grow || (clst = inode_grow(inode, 0, idx + 1)) == 0)
+		{
+			lock_release(&inode->map_lock);
+			return 0;
+		}
+		map_append(inode, 0, clst);
+	}
+
+	while (i < idx)
+	{
+		if (fat_get(clst) == EOChain && (!grow || inode_grow(inode, clst, idx - i) == 0))
+		{
+			clst = 0;
+			break;
+		}
+
+		clst = fat_get(clst);
+		map_append(inode, ++i, clst);
+	}
+	lock_release(&inode->map_lock);
+	return clst;
+}
+
+/* Appends a hole cluster to INODE's chain after its last cluster
+ * TAIL, or starts the chain with it if TAIL is 0, and returns it,
+ * or returns 0 if the disk is full.  The cluster is not written:
+ * it reads as zeros until inode_write_at() first writes to it.
+ * The cluster comes from INODE's preallocation window.  An empty
+ * window is refilled with a contiguous run of WANT clusters, the
+ * number the caller still needs, or PREALLOC_CLUSTERS if that is
+ * more; the run starts as close after TAIL as possible.  MAP_LOCK
+ * must be held. */
+static cluster_t
+inode_grow(struct inode *inode, cluster_t tail, size_t want)
+{
+	cluster_t clst;
+
+	if (inode->pa_cnt == 0)
+	{
+		if (want < PREALLOC_CLUSTERS)
+			want = PREALLOC_CLUSTERS;
+		inode->pa_cnt = fat_reserve(tail != 0 ? tail : sector_to_cluster(inode->sector),
+									want, &inode->pa_start);
+		if (inode->pa_cnt == 0)
+			return 0;
+	}
 
-	/* file length와 관계없이 pos에 크기에 따라 계속 진행
-	   file length보다 pos가 크면 새로운 cluster를 할당해가면서 진행 */
-	while (pos >= DISK_SECTOR_SIZE)
+	clst = inode->pa_start++;
+	inode->pa_cnt--;
+	if (tail != 0)
+		fat_chain_append(tail, clst);
+	else
 	{
-		if (fat_get(target) == EOChain)
-			fat_create_chain(target);
+		fat_put(clst, EOChain);
+		inode->data.start = cluster_to_sector(clst);
+		page_cache_write(inode->sector, inode->sector, &inode->data, 0,
+						 DISK_SECTOR_SIZE);
+	}
+	fat_set_hole(clst, true);
+	return clst;
+}
+
+/* Fills every sector of CLST with zeros on behalf of the inode in
+ * sector OWNER. */
+static void
+zero_cluster(cluster_t clst, disk_sector_t owner)
+{
+	static char zeros[DISK_SECTOR_SIZE];
+	disk_sector_t sector = cluster_to_sector(clst);
+	unsigned int i;
+
+	for (i = 0; i < fat_sectors_per_cluster(); i++)
+		page_cache_write(sector + i, owner, zeros, 0, DISK_SECTOR_SIZE);
+}
+
+/* Moves INODE's inline data into a newly allocated cluster, so
+ * that the file can grow past INLINE_MAX bytes.  Returns false if
+ * the disk is full.  The caller must hold INODE's rwlock for
+ * writing. */
+static bool
+inode_uninline(struct inode *inode)
+{
+	cluster_t clst = fat_create_chain(0);
+	if (clst == 0)
+		return false;
+
+	zero_cluster(clst, inode->sector);
+	if (inode->data.length > 0)
+		page_cache_write(cluster_to_sector(clst), inode->sector,
+						 inode->data.inline_data, 0, inode->data.length);
+
+	inode->data.is_inline = false;
+	inode->data.start = cluster_to_sector(clst);
+	memset(inode->data.inline_data, 0, sizeof inode->data.inline_data);
+	page_cache_write(inode->sector, inode->sector, &inode->data, 0,
+					 DISK_SECTOR_SIZE);
+	return true;
+}
+
+/* Makes sure INODE's chain has clusters for its first END bytes,
+ * reserving the missing ones as one contiguous run if possible.
+ * The new clusters are holes until written.  INODE's length does
+ * not change.  Returns false if the disk
+ * fills up first. */
+bool inode_allocate(struct inode *inode, off_t end)
+{
+	bool success = true;
+
+	if (end <= 0)
+		return true;
+
+	rwlock_write_acquire(&inode->rwlock);
+	if (inode->data.is_inline && end > INLINE_MAX)
+		success = inode_uninline(inode);
+	if (success && !inode->data.is_inline)
+		success = inode_cluster(inode, (end - 1) / cluster_bytes(), true) != 0;
+	rwlock_write_release(&inode->rwlock);
+
+	return success;
+}
 
-		target = fat_get(target);
-		pos -= DISK_SECTOR_SIZE;
+/* Returns the number of extents, that is, runs of consecutive
+ * clusters, that hold INODE's data.  Inline data takes none. */
+size_t inode_extent_cnt(struct inode *inode)
+{
+	size_t clusters, i;
+	size_t cnt = 0;
+	cluster_t prev = 0;
+
+	rwlock_read_acquire(&inode->rwlock);
+	clusters = inode->data.is_inline ? 0 : bytes_to_clusters(inode_length(inode));
+	for (i = 0; i < clusters; i++)
+	{
+		cluster_t clst = inode_cluster(inode, i, false);
+		if (clst == 0)
+			break;
+		if (i == 0 || clst != prev + 1)
+			cnt++;
+		prev = clst;
 	}
+	rwlock_read_release(&inode->rwlock);
 
-	disk_sector_t sector = cluster_to_sector(target);
-	return sector;
+	return cnt;
 }
 
-/* List of open inodes, so that opening a single inode twice
- * returns the same `struct inode'. */
-static struct list open_inodes;
+/* Inodes in memory, keyed by sector, so that opening a single
+ * inode twice returns the same `struct inode'.  Besides the open
+ * inodes, the table keeps up to inode_cache_limit inodes that were
+ * closed without being removed, in CLOSED_INODES from most to least
+ * recently closed.  Opening one of those again revives it without
+ * reading the disk, and keeps its cluster map and directory index;
+ * the least recently closed one is freed when the limit is passed. */
+static struct hash inode_table;
+static struct list closed_inodes;
+static size_t closed_cnt;		/* Number of inodes in closed_inodes. */
+unsigned inode_cache_limit = 64;
+
+/* Protects inode_table, closed_inodes and every inode's open_cnt. */
+static struct lock open_inodes_lock;
+
+/* Statistics. */
+static long long inode_hits;   /* Opens that found the inode in memory. */
+static long long inode_misses; /* Opens that read the inode from disk. */
+
+/* Returns a hash value for the inode containing E. */
+static uint64_t
+inode_hash(const struct hash_elem *e, void *aux UNUSED)
+{
+	disk_sector_t sector = hash_entry(e, struct inode, hash_elem)->sector;
+	return hash_bytes(&sector, sizeof sector);
+}
+
+/* Returns true if the inode containing A precedes the one
+ * containing B. */
+static bool
+inode_less(const struct hash_elem *a, const struct hash_elem *b, void *aux UNUSED)
+{
+	return hash_entry(a, struct inode, hash_elem)->sector < hash_entry(b, struct inode, hash_elem)->sector;
+}
+
+/* Frees INODE's memory. */
+static void
+inode_free(struct inode *inode)
+{
+	dir_index_destroy(inode->dir_index);
+	free(inode->map);
+	free(inode);
+}
 
 /* Initializes the inode module. */
 void inode_init(void)
 {
-	list_init(&open_inodes);
+	if (!hash_init(&inode_table, inode_hash, inode_less, NULL))
+		PANIC("inode table init failed");
+	list_init(&closed_inodes);
+	lock_init(&open_inodes_lock);
+}
+
+/* Prints inode cache statistics. */
+void inode_print_stats(void)
+{
+	printf("Inode cache: %lld hits, %lld misses, %zu inodes, %zu closed\n",
+		   inode_hits, inode_misses, hash_size(&inode_table), closed_cnt);
 }
 
 /* Initializes an inode with LENGTH bytes of data and
@@ -87,7 +378,6 @@ bool inode_create(disk_sector_t sector, off_t length, uint32_t is_dir)
 {
 
 	struct inode_disk *disk_inode = NULL;
-	cluster_t start_clst;
 	bool success = false;
 
 	ASSERT(length >= 0);
@@ -97,40 +387,19 @@ bool inode_create(disk_sector_t sector, off_t length, uint32_t is_dir)
 	disk_inode = calloc(1, sizeof *disk_inode);
 	if (disk_inode != NULL)
 	{
-		size_t sectors = bytes_to_sectors(length);
 		disk_inode->length = length;
 		disk_inode->is_dir = is_dir;
 		disk_inode->is_link = false;
 		disk_inode->magic = INODE_MAGIC;
 
-		/* data cluster allocation */
-		if (start_clst = fat_create_chain(0))
-		{
-			disk_inode->start = cluster_to_sector(start_clst);
-
-			/* write disk_inode on disk */
-			disk_write(filesys_disk, sector, disk_inode);
-
-			if (sectors > 0)
-			{
-				static char zeros[DISK_SECTOR_SIZE];
-				cluster_t target = start_clst;
-				disk_sector_t w_sector;
-				size_t i;
-
-				/* make cluster chain based length and initialize zero*/
-				while (sectors > 1)
-				{
-					w_sector = cluster_to_sector(target);
-					disk_write(filesys_disk, w_sector, zeros);
-
-					target = fat_create_chain(target);
-					sectors--;
-				}
-			}
-
-			success = true;
-		}
+		/* 작은 file은 data를 inode sector 안에 두고 cluster를 할당하지 않음
+		 * INLINE_MAX를 넘게 자라면 inode_uninline()이 cluster로 옮긴다.
+		 * 큰 file도 cluster를 할당하지 않고, 처음 쓸 때까지 file 전체가
+		 * hole(data.start == 0)이므로 길이와 관계없이 inode sector만 쓴다. */
+		disk_inode->is_inline = length <= INLINE_MAX;
+		disk_inode->start = 0;
+		page_cache_write(sector, sector, disk_inode, 0, DISK_SECTOR_SIZE);
+		success = true;
 		free(disk_inode);
 	}
 	return success;
@@ -157,7 +426,7 @@ bool inode_create_link(disk_sector_t sector, char *path_name)
 	if (start_clst = fat_create_chain(0))
 		disk_inode->start = cluster_to_sector(start_clst);
 
-	disk_write(filesys_disk, sector, disk_inode);
+	page_cache_write(sector, sector, disk_inode, 0, DISK_SECTOR_SIZE);
 
 	free(disk_inode);
 
@@ -170,34 +439,67 @@ bool inode_create_link(disk_sector_t sector, char *path_name)
 struct inode *
 inode_open(disk_sector_t sector)
 {
-	struct list_elem *e;
+	struct inode key;
+	struct hash_elem *e;
 	struct inode *inode;
 
-	/* Check whether this inode is already open. */
-	for (e = list_begin(&open_inodes); e != list_end(&open_inodes);
-		 e = list_next(e))
+	lock_acquire(&open_inodes_lock);
+
+	/* Check whether this inode is already in memory. */
+	key.sector = sector;
+	e = hash_find(&inode_table, &key.hash_elem);
+	if (e != NULL)
 	{
-		inode = list_entry(e, struct inode, elem);
-		if (inode->sector == sector)
+		inode = hash_entry(e, struct inode, hash_elem);
+		if (inode->open_cnt++ == 0)
 		{
-			inode_reopen(inode);
-			return inode;
+			list_remove(&inode->lru_elem);
+			closed_cnt--;
 		}
+		inode_hits++;
+
+		/* Another opener is still reading it in. */
+		while (inode->loading)
+			cond_wait(&inode->loaded, &open_inodes_lock);
+		lock_release(&open_inodes_lock);
+		return inode;
 	}
 
 	/* Allocate memory. */
 	inode = malloc(sizeof *inode);
 	if (inode == NULL)
+	{
+		lock_release(&open_inodes_lock);
 		return NULL;
+	}
 
-	/* Initialize. */
-	list_push_front(&open_inodes, &inode->elem);
+	/* Initialize.  The inode goes into the table marked LOADING
+	 * and is read in with the lock released, so that a slow read
+	 * does not hold up opens and closes of other inodes.  Other
+	 * openers of the same inode wait until it is loaded. */
+	inode_misses++;
 	inode->sector = sector;
+	hash_insert(&inode_table, &inode->hash_elem);
 	inode->open_cnt = 1;
+	inode->loading = true;
+	cond_init(&inode->loaded);
 	inode->deny_write_cnt = 0;
 	inode->removed = false;
-	disk_read(filesys_disk, inode->sector, &inode->data);
-
+	rwlock_init(&inode->rwlock);
+	lock_init(&inode->dir_lock);
+	inode->dir_index = NULL;
+	lock_init(&inode->map_lock);
+	inode->map = NULL;
+	inode->map_cnt = inode->map_cap = 0;
+	inode->pa_cnt = 0;
+	lock_release(&open_inodes_lock);
+
+	page_cache_read(inode->sector, &inode->data, 0, DISK_SECTOR_SIZE);
+
+	lock_acquire(&open_inodes_lock);
+	inode->loading = false;
+	cond_broadcast(&inode->loaded, &open_inodes_lock);
+	lock_release(&open_inodes_lock);
 	return inode;
 }
 
@@ -206,7 +508,11 @@ struct inode *
 inode_reopen(struct inode *inode)
 {
 	if (inode != NULL)
+	{
+		lock_acquire(&open_inodes_lock);
 		inode->open_cnt++;
+		lock_release(&open_inodes_lock);
+	}
 	return inode;
 }
 
@@ -218,8 +524,10 @@ inode_get_inumber(const struct inode *inode)
 }
 
 /* Closes INODE and writes it to disk.
- * If this was the last reference to INODE, frees its memory.
- * If INODE was also a removed inode, frees its blocks. */
+ * If this was the last reference to INODE, keeps it in the inode
+ * cache, freeing the least recently closed inode if the cache is
+ * full.  If INODE was also a removed inode, frees its memory and
+ * its blocks instead. */
 void inode_close(struct inode *inode)
 {
 	/* Ignore null pointer. */
@@ -227,30 +535,92 @@ void inode_close(struct inode *inode)
 		return;
 
 	/* Release resources if this was the last opener. */
-	if (--inode->open_cnt == 0)
+	lock_acquire(&open_inodes_lock);
+	if (--inode->open_cnt > 0)
 	{
-		/* Remove from inode list and release lock. */
-		list_remove(&inode->elem);
+		lock_release(&open_inodes_lock);
+		return;
+	}
 
-		/* Deallocate blocks if removed. */
-		if (inode->removed)
-		{
-			/* remove disk_inode */
-			cluster_t clst = sector_to_cluster(inode->sector);
-			fat_remove_chain(clst, 0);
+	/* Return the unused part of the preallocation window.  Nobody
+	 * else has INODE open, so MAP_LOCK is not needed. */
+	if (inode->pa_cnt > 0)
+	{
+		fat_unreserve(inode->pa_start, inode->pa_cnt);
+		inode->pa_cnt = 0;
+	}
 
-			/* remove file data */
-			clst = sector_to_cluster(inode->data.start);
-			// printf("[DEBUG]clst: %d\n", clst);
-			// print_fat(400, 500);
-			fat_remove_chain(clst, 0);
+	/* Keep INODE in the cache. */
+	if (!inode->removed)
+	{
+		list_push_front(&closed_inodes, &inode->lru_elem);
+		closed_cnt++;
+		while (closed_cnt > inode_cache_limit)
+		{
+			struct inode *victim = list_entry(list_pop_back(&closed_inodes),
+											  struct inode, lru_elem);
+			closed_cnt--;
+			hash_delete(&inode_table, &victim->hash_elem);
+			inode_free(victim);
 		}
+		lock_release(&open_inodes_lock);
+		return;
+	}
+
+	/* Remove from inode table and release lock. */
+	hash_delete(&inode_table, &inode->hash_elem);
+	lock_release(&open_inodes_lock);
 
-		// /* file을 닫을 때 disk_inode의 변경사항을 disk에 write */
-		// disk_write(filesys_disk, inode->sector, &inode->data);
+	/* Deallocate blocks. */
+	/* remove disk_inode */
+	cluster_t clst = sector_to_cluster(inode->sector);
+	fat_remove_chain(clst, 0);
 
-		free(inode);
+	/* remove file data */
+	if (!inode->data.is_inline && inode->data.start != 0)
+	{
+		clst = sector_to_cluster(inode->data.start);
+		// printf("[DEBUG]clst: %d\n", clst);
+		// print_fat(400, 500);
+		fat_remove_chain(clst, 0);
 	}
+
+	// /* file을 닫을 때 disk_inode의 변경사항을 disk에 write */
+	// disk_write(filesys_disk, inode->sector, &inode->data);
+
+	inode_free(inode);
+}
+
+/* Acquires INODE's directory lock.  Directory code holds it
+ * across a lookup and the entry write that depends on it, so that
+ * two changes to the same directory cannot pick the same slot or
+ * add the same name twice.  Lookups hold it too, since they use
+ * the directory's index. */
+void inode_dir_lock(struct inode *inode)
+{
+	lock_acquire(&inode->dir_lock);
+}
+
+/* Releases INODE's directory lock. */
+void inode_dir_unlock(struct inode *inode)
+{
+	lock_release(&inode->dir_lock);
+}
+
+/* Returns the directory index attached to INODE, or a null
+ * pointer.  The caller must hold INODE's directory lock. */
+struct dir_index *
+inode_get_dir_index(struct inode *inode)
+{
+	return inode->dir_index;
+}
+
+/* Attaches directory index INDEX to INODE.  It is freed with
+ * dir_index_destroy() when INODE is closed for the last time.
+ * The caller must hold INODE's directory lock. */
+void inode_set_dir_index(struct inode *inode, struct dir_index *index)
+{
+	inode->dir_index = index;
 }
 
 /* Marks INODE to be deleted when it is closed by the last caller who
@@ -268,18 +638,26 @@ off_t inode_read_at(struct inode *inode, void *buffer_, off_t size, off_t offset
 {
 	uint8_t *buffer = buffer_;
 	off_t bytes_read = 0;
-	uint8_t *bounce = NULL;
 
 	// printf("[DEBUG][inode_read_at]inode: %p\n", inode);
 	// printf("[DEBUG][inode_read_at]buffer: %p\n", buffer_);
 	// printf("[DEBUG][inode_read_at]size: %d\n", size);
 	// printf("[DEBUG][inode_read_at]offset: %d\n\n", offset);
 
+	rwlock_read_acquire(&inode->rwlock);
+	if (inode->data.is_inline)
+	{
+		if (offset < inode_length(inode))
+		{
+			bytes_read = inode_length(inode) - offset;
+			if (bytes_read > size)
+				bytes_read = size;
+			memcpy(buffer, inode->data.inline_data + offset, bytes_read);
+		}
+		size = 0;
+	}
 	while (size > 0)
 	{
-		/* Disk sector to read, starting byte offset within sector. */
-		disk_sector_t sector_idx = byte_to_sector(inode, offset);
-
 		int sector_ofs = offset % DISK_SECTOR_SIZE;
 
 		/* Bytes left in inode, bytes left in sector, lesser of the two. */
@@ -292,38 +670,105 @@ off_t inode_read_at(struct inode *inode, void *buffer_, off_t size, off_t offset
 		if (chunk_size <= 0)
 			break;
 
-		if (sector_ofs == 0 && chunk_size == DISK_SECTOR_SIZE)
-		{
-			/* Read full sector directly into caller's buffer. */
-			disk_read(filesys_disk, sector_idx, buffer + bytes_read);
-		}
+		/* Cluster to read.  Past the end of the chain or in a hole
+		 * cluster the file reads as zeros, without touching the
+		 * disk. */
+		cluster_t clst = byte_to_cluster(inode, offset, false);
+		if (clst == 0 || fat_is_hole(clst))
+			memset(buffer + bytes_read, 0, chunk_size);
 		else
-		{
-			/* Read sector into bounce buffer, then partially copy
-			 * into caller's buffer. */
-			if (bounce == NULL)
-			{
-				bounce = malloc(DISK_SECTOR_SIZE);
-				if (bounce == NULL)
-					break;
-			}
-
-			// printf("[DEBUG][inode_read_at]sector_idx: %d\n", sector_idx);
-			disk_read(filesys_disk, sector_idx, bounce);
-			memcpy(buffer + bytes_read, bounce + sector_ofs, chunk_size);
-		}
+			page_cache_read(byte_to_sector(clst, offset), buffer + bytes_read,
+							sector_ofs, chunk_size);
 
 		/* Advance. */
 		size -= chunk_size;
 		offset += chunk_size;
 		bytes_read += chunk_size;
 	}
-
-	free(bounce);
+	rwlock_read_release(&inode->rwlock);
 
 	return bytes_read;
 }
 
+/* Queues the sectors of INODE that hold bytes START through
+ * END - 1 for read-ahead, stopping at end of file.  Returns
+ * without waiting for the reads. */
+void inode_readahead(struct inode *inode, off_t start, off_t end)
+{
+	off_t pos;
+
+	rwlock_read_acquire(&inode->rwlock);
+	if (end > inode_length(inode))
+		end = inode_length(inode);
+	/* Inline data is already in memory. */
+	if (inode->data.is_inline)
+		end = 0;
+
+	/* Holes have nothing to read. */
+	for (pos = ROUND_DOWN(start, DISK_SECTOR_SIZE); pos < end;
+		 pos += DISK_SECTOR_SIZE)
+	{
+		cluster_t clst = byte_to_cluster(inode, pos, false);
+		if (clst != 0 && !fat_is_hole(clst))
+			page_cache_prefetch(byte_to_sector(clst, pos));
+	}
+	rwlock_read_release(&inode->rwlock);
+}
+
+/* Returns the offset of the first byte at or after POS that holds
+ * data rather than lying in a hole, or -1 if there is none before
+ * end of file.  Holes are whole clusters, so the result is POS or
+ * the start of a cluster. */
+off_t inode_seek_data(struct inode *inode, off_t pos)
+{
+	off_t length, result = -1;
+
+	rwlock_read_acquire(&inode->rwlock);
+	length = inode_length(inode);
+	if (inode->data.is_inline)
+		result = pos < length ? pos : -1;
+	else
+		for (; pos < length; pos = ROUND_DOWN(pos, cluster_bytes()) + cluster_bytes())
+		{
+			cluster_t clst = byte_to_cluster(inode, pos, false);
+			if (clst == 0)
+				break;
+			if (!fat_is_hole(clst))
+			{
+				result = pos;
+				break;
+			}
+		}
+	rwlock_read_release(&inode->rwlock);
+
+	return result;
+}
+
+/* Returns the offset of the first byte at or after POS that lies in
+ * a hole, counting end of file as the start of one, or -1 if POS
+ * is at or past end of file. */
+off_t inode_seek_hole(struct inode *inode, off_t pos)
+{
+	off_t length, result;
+
+	rwlock_read_acquire(&inode->rwlock);
+	length = inode_length(inode);
+	result = pos < length ? length : -1;
+	if (!inode->data.is_inline)
+		for (; pos < length; pos = ROUND_DOWN(pos, cluster_bytes()) + cluster_bytes())
+		{
+			cluster_t clst = byte_to_cluster(inode, pos, false);
+			if (clst == 0 || fat_is_hole(clst))
+			{
+				result = pos;
+				break;
+			}
+		}
+	rwlock_read_release(&inode->rwlock);
+
+	return result;
+}
+
 /* Writes SIZE bytes from BUFFER into INODE, starting at OFFSET.
  * Returns the number of bytes actually written, which may be
  * less than SIZE if end of file is reached or an error occurs.
@@ -333,17 +778,43 @@ off_t inode_write_at(struct inode *inode, const void *buffer_, off_t size, off_t
 {
 	const uint8_t *buffer = buffer_;
 	off_t bytes_written = 0;
-	uint8_t *bounce = NULL;
 	off_t origin_offset = offset;
 
+	rwlock_write_acquire(&inode->rwlock);
 	if (inode->deny_write_cnt)
+	{
+		rwlock_write_release(&inode->rwlock);
 		return 0;
+	}
+
+	/* Inline data is written into the inode itself.  Data that no
+	 * longer fits is moved out to a cluster first. */
+	if (inode->data.is_inline)
+	{
+		if (offset + size <= INLINE_MAX)
+		{
+			memcpy(inode->data.inline_data + offset, buffer, size);
+			if (inode_length(inode) < offset + size)
+				inode->data.length = offset + size;
+			page_cache_write(inode->sector, inode->sector, &inode->data, 0,
+							 DISK_SECTOR_SIZE);
+			rwlock_write_release(&inode->rwlock);
+			return size;
+		}
+		if (!inode_uninline(inode))
+		{
+			rwlock_write_release(&inode->rwlock);
+			return 0;
+		}
+	}
 
 	while (size > 0)
 	{
-		/* Sector to write, starting byte offset within sector. */
-		disk_sector_t sector_idx = byte_to_sector(inode, offset);
+		/* Cluster to write, starting byte offset within sector. */
+		cluster_t clst = byte_to_cluster(inode, offset, true);
 		int sector_ofs = offset % DISK_SECTOR_SIZE;
+		if (clst == 0)
+			break;
 
 		/* Bytes left in inode, bytes left in sector, lesser of the two. */
 		/* file growth에 의해 length가 길어질 수 있기 때문에 length에 의한 제한을 없앰 */
@@ -355,31 +826,18 @@ off_t inode_write_at(struct inode *inode, const void *buffer_, off_t size, off_t
 		if (chunk_size <= 0)
 			break;
 
-		if (sector_ofs == 0 && chunk_size == DISK_SECTOR_SIZE)
+		/* A hole cluster may hold stale data on disk, so it is zeroed
+		 * before its first write, unless that write covers it all. */
+		if (fat_is_hole(clst))
 		{
-			/* Write full sector directly to disk. */
-			disk_write(filesys_disk, sector_idx, buffer + bytes_written);
+			if (chunk_size < cluster_bytes())
+				zero_cluster(clst, inode->sector);
+			fat_set_hole(clst, false);
 		}
-		else
-		{
-			/* We need a bounce buffer. */
-			if (bounce == NULL)
-			{
-				bounce = malloc(DISK_SECTOR_SIZE);
-				if (bounce == NULL)
-					break;
-			}
+		disk_sector_t sector_idx = byte_to_sector(clst, offset);
 
-			/* If the sector contains data before or after the chunk
-			   we're writing, then we need to read in the sector
-			   first.  Otherwise we start with a sector of all zeros. */
-			if (sector_ofs > 0 || chunk_size < sector_left)
-				disk_read(filesys_disk, sector_idx, bounce);
-			else
-				memset(bounce, 0, DISK_SECTOR_SIZE);
-			memcpy(bounce + sector_ofs, buffer + bytes_written, chunk_size);
-			disk_write(filesys_disk, sector_idx, bounce);
-		}
+		page_cache_write(sector_idx, inode->sector, buffer + bytes_written,
+						 sector_ofs, chunk_size);
 
 		/* Advance. */
 		size -= chunk_size;
@@ -387,24 +845,34 @@ off_t inode_write_at(struct inode *inode, const void *buffer_, off_t size, off_t
 		bytes_written += chunk_size;
 	}
 
-	free(bounce);
-
 	/* file growth 됬을 때 inode의 length 갱신 */
 	if (inode_length(inode) < origin_offset + bytes_written)
 	{
 		inode->data.length = origin_offset + bytes_written;
-		disk_write(filesys_disk, inode->sector, &inode->data);
+		page_cache_write(inode->sector, inode->sector, &inode->data, 0,
+						 DISK_SECTOR_SIZE);
 	}
+	rwlock_write_release(&inode->rwlock);
 
 	return bytes_written;
 }
 
+/* Writes INODE's dirty data and the inode itself to disk, along
+ * with the FAT that links its data together. */
+void inode_sync(struct inode *inode)
+{
+	page_cache_flush_owner(inode->sector);
+	fat_sync();
+}
+
 /* Disables writes to INODE.
    May be called at most once per inode opener. */
 void inode_deny_write(struct inode *inode)
 {
+	rwlock_write_acquire(&inode->rwlock);
 	inode->deny_write_cnt++;
 	ASSERT(inode->deny_write_cnt <= inode->open_cnt);
+	rwlock_write_release(&inode->rwlock);
 }
 
 /* Re-enables writes to INODE.
@@ -412,9 +880,11 @@ void inode_deny_write(struct inode *inode)
  * inode_deny_write() on the inode, before closing the inode. */
 void inode_allow_write(struct inode *inode)
 {
+	rwlock_write_acquire(&inode->rwlock);
 	ASSERT(inode->deny_write_cnt > 0);
 	ASSERT(inode->deny_write_cnt <= inode->open_cnt);
 	inode->deny_write_cnt--;
+	rwlock_write_release(&inode->rwlock);
 }
 
 /* Returns the length, in bytes, of INODE's data. */
@@ -1,9 +1,119 @@
 /* page_cache.c: Implementation of Page Cache (Buffer Cache). */
 
+#include "filesys/page_cache.h"
+#include <debug.h>
+#include <stdio.h>
+#include <string.h>
+#include "devices/timer.h"
+#include "filesys/fat.h"
+#include "filesys/filesys.h"
+#include "threads/palloc.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "threads/vaddr.h"
 #include "vm/vm.h"
+
+/* Buffer cache.
+ *
+ * Every sector of the file system disk that inode.c reads or
+ * writes goes through a cache of CACHE_SIZE sectors.  A write
+ * only updates the cached copy and marks it dirty; the sector
+ * reaches the disk when its entry is evicted, when the flusher
+ * thread finds it old enough or the cache too dirty, when its
+ * file is fsync()'d, or when page_cache_flush() runs from
+ * filesys_done().  Victims are picked with the clock algorithm.
+ *
+ * CACHE_LOCK protects the binding of entries to sectors, the pin
+ * counts and the clock hand.  Each entry's own lock protects its
+ * data, so disk I/O on one entry does not hold up hits on the
+ * others.  An entry with a nonzero pin count is in use by some
+ * thread and is never evicted; an entry whose pin count is zero
+ * has its lock free, so its DIRTY flag may be read under
+ * CACHE_LOCK alone.  The flusher also reads DIRTY, DIRTY_SINCE
+ * and OWNER of pinned entries under CACHE_LOCK, but only as a
+ * hint: it checks DIRTY again under the entry's lock. */
+
+/* Number of cached sectors. */
+#define CACHE_SIZE 64
+
+/* A cached sector. */
+struct cache_entry {
+	disk_sector_t sector;       /* Cached sector, if VALID. */
+	bool valid;                 /* Bound to SECTOR? */
+	bool loaded;                /* DATA holds SECTOR's contents? */
+	bool dirty;                 /* DATA newer than the disk? */
+	bool accessed;              /* Used since the clock hand passed? */
+	int64_t dirty_since;        /* Tick at which DIRTY became true. */
+	disk_sector_t owner;        /* Inode of the last writer. */
+	int pin_cnt;                /* Threads using or waiting for LOCK. */
+	struct lock lock;           /* Protects DATA, LOADED, DIRTY,
+	                               DIRTY_SINCE and OWNER. */
+	uint8_t *data;              /* DISK_SECTOR_SIZE bytes. */
+};
+
+static struct cache_entry cache[CACHE_SIZE];
+static struct lock cache_lock;
+static struct condition cache_unpinned;  /* Some pin count hit 0. */
+static size_t clock_hand;
+static int cache_dirty_cnt;              /* Number of dirty entries. */
+static struct condition cache_dirtied;   /* CACHE_DIRTY_CNT left 0. */
+
+/* Write-behind.  page_cache_flusherd sleeps while the cache is
+ * clean.  Otherwise it wakes every FLUSH_INTERVAL milliseconds
+ * and writes back the entries that have been dirty for at least
+ * page_cache_dirty_age milliseconds, or every dirty entry if more
+ * than page_cache_dirty_ratio percent of the cache is dirty.  After
+ * each pass it also writes the FAT sectors that changed, after the
+ * data they point to. */
+#define FLUSH_INTERVAL 500
+unsigned page_cache_dirty_age = 3000;
+unsigned page_cache_dirty_ratio = 50;
+
+/* Runs of adjacent sectors move to and from the disk in a single
+ * multi-sector transfer, staged in a page since the entries'
+ * data are not in sector order.  A run holds at most RUN_MAX
+ * sectors.  FLUSH_BUF, guarded by FLUSH_LOCK, stages write-back;
+ * RA_BUF belongs to the read-ahead worker. */
+#define RUN_MAX (PGSIZE / DISK_SECTOR_SIZE)
+static uint8_t *flush_buf;
+static struct lock flush_lock;
+static uint8_t *ra_buf;
+
+/* Statistics. */
+static long long cache_hits;        /* Lookups that found the sector. */
+static long long cache_misses;      /* Lookups that had to bind an entry. */
+static long long cache_writebacks;  /* Dirty sectors written to disk. */
+static long long cache_readaheads;  /* Sectors read in by the worker. */
+
+/* Read-ahead.  Readers queue sectors they expect to need soon and
+ * page_cache_kworkerd reads them into the cache in the
+ * background.  The queue is a ring of RA_QUEUE_SIZE sectors; when
+ * it is full, further requests are dropped, since read-ahead is
+ * only a hint. */
+#define RA_QUEUE_SIZE 128
+static disk_sector_t ra_queue[RA_QUEUE_SIZE];
+static unsigned ra_head;            /* Next slot to fill. */
+static unsigned ra_tail;            /* Next slot to read. */
+static struct lock ra_lock;         /* Protects the queue. */
+static struct condition ra_nonempty;
+
+static struct cache_entry *cache_get (disk_sector_t, bool demand);
+static void cache_put (struct cache_entry *);
+static void cache_clean (struct cache_entry *);
+static void cache_dirty (struct cache_entry *, disk_sector_t owner);
+static int cache_write_run (struct cache_entry **, size_t cnt);
+static void cache_flush_batch (bool (*select) (const struct cache_entry *,
+			void *aux), void *aux);
+static bool select_all (const struct cache_entry *, void *aux);
+static bool select_dirtied_before (const struct cache_entry *, void *aux);
+static bool select_owner (const struct cache_entry *, void *aux);
+static void page_cache_flusherd (void *aux);
+static struct cache_entry *cache_lookup (disk_sector_t);
+static struct cache_entry *cache_choose_victim (void);
 static bool page_cache_readahead (struct page *page, void *kva);
 static bool page_cache_writeback (struct page *page);
 static void page_cache_destroy (struct page *page);
+static void page_cache_kworkerd (void *aux);
 
 /* DO NOT MODIFY this struct */
 static const struct page_operations page_cache_op = {
@@ -13,12 +123,13 @@ static const struct page_operations page_cache_op = {
 	.type = VM_PAGE_CACHE,
 };
 
-tid_t page_cache_workerd;
+tid_t page_cache_workerd = TID_ERROR;
 
 /* The initializer of file vm */
 void
 pagecache_init (void) {
-	/* TODO: Create a worker daemon for page cache with page_cache_kworkerd */
+	page_cache_workerd = thread_create ("page_cache_kworkerd", PRI_DEFAULT,
+			page_cache_kworkerd, NULL);
 }
 
 /* Initialize the page cache */
@@ -44,7 +155,457 @@ static void
 page_cache_destroy (struct page *page) {
 }
 
-/* Worker thread for page cache */
+/* Worker thread for page cache.  Reads queued sectors into the
+ * cache, skipping those that are already there.  Sectors queued
+ * back to back that are also adjacent on disk are read with one
+ * transfer. */
+static void
+page_cache_kworkerd (void *aux UNUSED) {
+	for (;;) {
+		struct cache_entry *run[RUN_MAX];
+		disk_sector_t first;
+		size_t cnt, i;
+		int read = 0;
+
+		lock_acquire (&ra_lock);
+		while (ra_head == ra_tail)
+			cond_wait (&ra_nonempty, &ra_lock);
+		first = ra_queue[ra_tail++ % RA_QUEUE_SIZE];
+		for (cnt = 1; cnt < RUN_MAX && ra_head != ra_tail; cnt++, ra_tail++)
+			if (ra_queue[ra_tail % RA_QUEUE_SIZE] != first + cnt)
+				break;
+		lock_release (&ra_lock);
+
+		/* Bind the sectors that are not cached yet, in ascending
+		 * order, and read each stretch of them at once. */
+		for (i = 0; i < cnt; i++)
+			run[i] = cache_get (first + i, false);
+		for (i = 0; i < cnt; ) {
+			size_t n, j;
+
+			if (run[i] == NULL) {
+				i++;
+				continue;
+			}
+			for (n = 1; i + n < cnt && run[i + n] != NULL; n++)
+				continue;
+
+			if (n == 1)
+				disk_read (filesys_disk, first + i, run[i]->data);
+			else {
+				disk_read_multiple (filesys_disk, first + i, n, ra_buf);
+				for (j = 0; j < n; j++)
+					memcpy (run[i + j]->data, ra_buf + j * DISK_SECTOR_SIZE,
+							DISK_SECTOR_SIZE);
+			}
+			for (j = 0; j < n; j++) {
+				run[i + j]->loaded = true;
+				cache_put (run[i + j]);
+			}
+			read += n;
+			i += n;
+		}
+
+		if (read > 0) {
+			lock_acquire (&cache_lock);
+			cache_readaheads += read;
+			lock_release (&cache_lock);
+		}
+	}
+}
+
+/* Initializes the buffer cache. */
+void
+page_cache_init (void) {
+	uint8_t *base;
+	size_t i;
+
+	base = palloc_get_multiple (PAL_ASSERT,
+			CACHE_SIZE * DISK_SECTOR_SIZE / PGSIZE);
+	lock_init (&cache_lock);
+	cond_init (&cache_unpinned);
+	cond_init (&cache_dirtied);
+	cache_dirty_cnt = 0;
+	lock_init (&ra_lock);
+	cond_init (&ra_nonempty);
+	ra_head = ra_tail = 0;
+	flush_buf = palloc_get_page (PAL_ASSERT);
+	lock_init (&flush_lock);
+	ra_buf = palloc_get_page (PAL_ASSERT);
+	for (i = 0; i < CACHE_SIZE; i++) {
+		struct cache_entry *e = &cache[i];
+
+		e->valid = e->loaded = e->dirty = e->accessed = false;
+		e->pin_cnt = 0;
+		lock_init (&e->lock);
+		e->data = base + i * DISK_SECTOR_SIZE;
+	}
+	clock_hand = 0;
+
+	thread_create ("page_cache_flusherd", PRI_DEFAULT, page_cache_flusherd,
+			NULL);
+}
+
+/* Copies SIZE bytes starting at byte OFS of SECTOR into BUFFER. */
+void
+page_cache_read (disk_sector_t sector, void *buffer, off_t ofs,
+		size_t size) {
+	struct cache_entry *e;
+
+	ASSERT (ofs >= 0 && ofs + size <= DISK_SECTOR_SIZE);
+
+	e = cache_get (sector, true);
+	if (!e->loaded) {
+		disk_read (filesys_disk, sector, e->data);
+		e->loaded = true;
+	}
+	memcpy (buffer, e->data + ofs, size);
+	cache_put (e);
+}
+
+/* Copies SIZE bytes from BUFFER into SECTOR starting at byte
+ * OFS, on behalf of the inode in sector OWNER.  The sector is
+ * written to disk later. */
+void
+page_cache_write (disk_sector_t sector, disk_sector_t owner,
+		const void *buffer, off_t ofs, size_t size) {
+	struct cache_entry *e;
+
+	ASSERT (ofs >= 0 && ofs + size <= DISK_SECTOR_SIZE);
+
+	e = cache_get (sector, true);
+	if (!e->loaded) {
+		/* A partial write needs the rest of the sector. */
+		if (ofs != 0 || size != DISK_SECTOR_SIZE)
+			disk_read (filesys_disk, sector, e->data);
+		e->loaded = true;
+	}
+	memcpy (e->data + ofs, buffer, size);
+	cache_dirty (e, owner);
+	cache_put (e);
+}
+
+/* Asks the read-ahead worker to bring SECTOR into the cache.
+ * Returns at once; does nothing if there is no worker or its
+ * queue is full. */
+void
+page_cache_prefetch (disk_sector_t sector) {
+	if (page_cache_workerd == TID_ERROR)
+		return;
+
+	lock_acquire (&ra_lock);
+	if (ra_head - ra_tail < RA_QUEUE_SIZE) {
+		ra_queue[ra_head++ % RA_QUEUE_SIZE] = sector;
+		cond_signal (&ra_nonempty, &ra_lock);
+	}
+	lock_release (&ra_lock);
+}
+
+/* Writes every dirty sector in the cache to disk. */
+void
+page_cache_flush (void) {
+	cache_flush_batch (select_all, NULL);
+}
+
+/* Writes every dirty sector last written on behalf of the inode
+ * in sector OWNER to disk. */
+void
+page_cache_flush_owner (disk_sector_t owner) {
+	cache_flush_batch (select_owner, &owner);
+}
+
+/* Prints buffer cache statistics. */
+void
+page_cache_print_stats (void) {
+	printf ("Buffer cache: %lld hits, %lld misses, %lld writebacks, "
+			"%lld read-ahead\n",
+			cache_hits, cache_misses, cache_writebacks, cache_readaheads);
+}
+
+/* Returns the entry bound to SECTOR, binding one if needed, with
+ * its lock held.  The entry's data is valid only if LOADED.
+ * DEMAND is false for read-ahead, which is not counted in the
+ * statistics and gets a null pointer back if SECTOR is already
+ * cached. */
+static struct cache_entry *
+cache_get (disk_sector_t sector, bool demand) {
+	struct cache_entry *e;
+
+	lock_acquire (&cache_lock);
+	for (;;) {
+		e = cache_lookup (sector);
+		if (e != NULL && !demand) {
+			lock_release (&cache_lock);
+			return NULL;
+		}
+		if (e != NULL) {
+			cache_hits++;
+			e->pin_cnt++;
+			e->accessed = true;
+			lock_release (&cache_lock);
+			lock_acquire (&e->lock);
+			return e;
+		}
+
+		e = cache_choose_victim ();
+		if (!e->valid || !e->dirty)
+			break;
+
+		/* Write the victim back while it is still bound to its old
+		 * sector, so that nobody can read that sector from disk
+		 * before the write lands.  Then look again, since SECTOR
+		 * may have been cached meanwhile and the victim used. */
+		cache_clean (e);
+	}
+
+	/* Bind the clean victim.  Its lock is free because its pin
+	 * count was zero, so acquiring it here does not block. */
+	if (demand)
+		cache_misses++;
+	e->sector = sector;
+	e->valid = true;
+	e->loaded = false;
+	e->accessed = true;
+	e->pin_cnt = 1;
+	lock_acquire (&e->lock);
+	lock_release (&cache_lock);
+	return e;
+}
+
+/* Writes entry E to disk if it is dirty.  E stays bound to its
+ * sector throughout, because it is pinned while CACHE_LOCK is
+ * dropped for the write.  CACHE_LOCK must be held. */
 static void
-page_cache_kworkerd (void *aux) {
+cache_clean (struct cache_entry *e) {
+	bool written = false;
+
+	e->pin_cnt++;
+	lock_release (&cache_lock);
+
+	lock_acquire (&e->lock);
+	if (e->dirty) {
+		disk_write (filesys_disk, e->sector, e->data);
+		e->dirty = false;
+		written = true;
+	}
+	lock_release (&e->lock);
+
+	lock_acquire (&cache_lock);
+	if (written) {
+		cache_writebacks++;
+		cache_dirty_cnt--;
+	}
+	if (--e->pin_cnt == 0)
+		cond_signal (&cache_unpinned, &cache_lock);
+}
+
+/* Marks entry E, whose lock the caller holds, dirty on behalf of
+ * the inode in sector OWNER. */
+static void
+cache_dirty (struct cache_entry *e, disk_sector_t owner) {
+	e->owner = owner;
+	if (e->dirty)
+		return;
+
+	e->dirty = true;
+	e->dirty_since = timer_ticks ();
+
+	lock_acquire (&cache_lock);
+	if (cache_dirty_cnt++ == 0)
+		cond_signal (&cache_dirtied, &cache_lock);
+	lock_release (&cache_lock);
+}
+
+/* Writes back, in ascending sector order, every dirty entry for
+ * which SELECT returns true given AUX.  Writing in order lets
+ * each run of adjacent sectors go out in one transfer. */
+static void
+cache_flush_batch (bool (*select) (const struct cache_entry *, void *aux),
+		void *aux) {
+	struct cache_entry *batch[CACHE_SIZE];
+	size_t cnt = 0;
+	int written = 0;
+	size_t i;
+
+	/* Pin the selected entries so that they stay bound. */
+	lock_acquire (&cache_lock);
+	for (i = 0; i < CACHE_SIZE; i++) {
+		struct cache_entry *e = &cache[i];
+
+		if (e->valid && e->dirty && select (e, aux)) {
+			e->pin_cnt++;
+			batch[cnt++] = e;
+		}
+	}
+	lock_release (&cache_lock);
+
+	/* Insertion sort by sector; the batch is small. */
+	for (i = 1; i < cnt; i++) {
+		struct cache_entry *e = batch[i];
+		size_t j;
+
+		for (j = i; j > 0 && batch[j - 1]->sector > e->sector; j--)
+			batch[j] = batch[j - 1];
+		batch[j] = e;
+	}
+
+	lock_acquire (&flush_lock);
+	for (i = 0; i < cnt; ) {
+		size_t n;
+
+		for (n = 1; i + n < cnt && n < RUN_MAX; n++)
+			if (batch[i + n]->sector != batch[i]->sector + n)
+				break;
+		written += cache_write_run (batch + i, n);
+		i += n;
+	}
+	lock_release (&flush_lock);
+
+	lock_acquire (&cache_lock);
+	cache_writebacks += written;
+	cache_dirty_cnt -= written;
+	for (i = 0; i < cnt; i++)
+		if (--batch[i]->pin_cnt == 0)
+			cond_signal (&cache_unpinned, &cache_lock);
+	lock_release (&cache_lock);
+}
+
+/* Writes back the entries that are still dirty among the CNT
+ * pinned entries in RUN, which hold adjacent sectors in ascending
+ * order, and returns how many it wrote.  Dirty neighbours go out
+ * in one transfer through FLUSH_BUF, so FLUSH_LOCK must be held.
+ * The entries' locks are taken in ascending sector order, which
+ * keeps concurrent flushes from deadlocking. */
+static int
+cache_write_run (struct cache_entry **run, size_t cnt) {
+	int written = 0;
+	size_t i, j;
+
+	for (i = 0; i < cnt; i++)
+		lock_acquire (&run[i]->lock);
+
+	for (i = 0; i < cnt; ) {
+		size_t n;
+
+		if (!run[i]->dirty) {
+			i++;
+			continue;
+		}
+		for (n = 1; i + n < cnt && run[i + n]->dirty; n++)
+			continue;
+
+		if (n == 1)
+			disk_write (filesys_disk, run[i]->sector, run[i]->data);
+		else {
+			for (j = 0; j < n; j++)
+				memcpy (flush_buf + j * DISK_SECTOR_SIZE, run[i + j]->data,
+						DISK_SECTOR_SIZE);
+			disk_write_multiple (filesys_disk, run[i]->sector, n, flush_buf);
+		}
+		for (j = 0; j < n; j++)
+			run[i + j]->dirty = false;
+		written += n;
+		i += n;
+	}
+
+	for (i = 0; i < cnt; i++)
+		lock_release (&run[i]->lock);
+	return written;
+}
+
+/* Selects every entry. */
+static bool
+select_all (const struct cache_entry *e UNUSED, void *aux UNUSED) {
+	return true;
+}
+
+/* Selects entries dirty since before the tick that AUX points to. */
+static bool
+select_dirtied_before (const struct cache_entry *e, void *aux) {
+	const int64_t *tick = aux;
+
+	return e->dirty_since <= *tick;
+}
+
+/* Selects entries last written on behalf of the inode in the
+ * sector that AUX points to. */
+static bool
+select_owner (const struct cache_entry *e, void *aux) {
+	const disk_sector_t *owner = aux;
+
+	return e->owner == *owner;
+}
+
+/* Write-behind thread.  See the comment on FLUSH_INTERVAL. */
+static void
+page_cache_flusherd (void *aux UNUSED) {
+	for (;;) {
+		bool too_dirty;
+
+		lock_acquire (&cache_lock);
+		while (cache_dirty_cnt == 0)
+			cond_wait (&cache_dirtied, &cache_lock);
+		lock_release (&cache_lock);
+
+		timer_msleep (FLUSH_INTERVAL);
+
+		lock_acquire (&cache_lock);
+		too_dirty = cache_dirty_cnt * 100
+			> (int) (CACHE_SIZE * page_cache_dirty_ratio);
+		lock_release (&cache_lock);
+
+		if (too_dirty)
+			cache_flush_batch (select_all, NULL);
+		else {
+			int64_t before = timer_ticks ()
+				- (int64_t) page_cache_dirty_age * TIMER_FREQ / 1000;
+			cache_flush_batch (select_dirtied_before, &before);
+		}
+		fat_sync ();
+	}
+}
+
+/* Releases entry E obtained from cache_get(). */
+static void
+cache_put (struct cache_entry *e) {
+	lock_release (&e->lock);
+
+	lock_acquire (&cache_lock);
+	if (--e->pin_cnt == 0)
+		cond_signal (&cache_unpinned, &cache_lock);
+	lock_release (&cache_lock);
+}
+
+/* Returns the entry bound to SECTOR, or a null pointer if there
+ * is none.  CACHE_LOCK must be held. */
+static struct cache_entry *
+cache_lookup (disk_sector_t sector) {
+	size_t i;
+
+	for (i = 0; i < CACHE_SIZE; i++)
+		if (cache[i].valid && cache[i].sector == sector)
+			return &cache[i];
+	return NULL;
+}
+
+/* Returns an unpinned entry to reuse, preferring unbound entries
+ * and otherwise the first one the clock hand finds unaccessed.
+ * Waits if every entry is pinned.  CACHE_LOCK must be held. */
+static struct cache_entry *
+cache_choose_victim (void) {
+	for (;;) {
+		size_t i;
+
+		for (i = 0; i < 2 * CACHE_SIZE; i++) {
+			struct cache_entry *e = &cache[clock_hand];
+
+			clock_hand = (clock_hand + 1) % CACHE_SIZE;
+			if (e->pin_cnt > 0)
+				continue;
+			if (!e->valid || !e->accessed)
+				return e;
+			e->accessed = false;
+		}
+		cond_wait (&cache_unpinned, &cache_lock);
+	}
 }
@@ -0,0 +1,19 @@
+#ifndef FILESYS_DCACHE_H
+#define FILESYS_DCACHE_H
+#include <stdbool.h>
+#include "devices/disk.h"
+
+struct inode;
+
+/* Cached result for a name that does not exist. */
+#define DCACHE_NEGATIVE ((disk_sector_t) -1)
+
+void dcache_init (void);
+bool dcache_lookup (struct inode *dir, const char *name,
+		disk_sector_t *sector);
+void dcache_insert (struct inode *dir, const char *name,
+		disk_sector_t sector);
+void dcache_invalidate (struct inode *dir, const char *name);
+void dcache_purge (struct inode *dir);
+void dcache_print_stats (void);
+#endif
@@ -14,18 +14,23 @@ typedef uint32_t cluster_t; /* Index of a cluster within FAT. */
 #define EOChain 0x0FFFFFFF   /* End of cluster chain */
 
 /* Sectors of FAT information. */
-#define SECTORS_PER_CLUSTER 1 /* Number of sectors per cluster */
+#define SECTORS_PER_CLUSTER 1 /* Default number of sectors per cluster */
+#define MAX_SECTORS_PER_CLUSTER 64
 #define FAT_BOOT_SECTOR 0     /* FAT boot sector. */
 #define ROOT_DIR_CLUSTER 1    /* Cluster for the root directory */
 
+/* Sectors per cluster to format with, set by the -cs kernel option. */
+extern unsigned int fat_format_sectors_per_cluster;
+
 void fat_init(void);
 void fat_open(void);
 void fat_close(void);
 void fat_create(void);
 void fat_close(void);
+void fat_sync(void);
 
 cluster_t fat_create_chain(
-    cluster_t clst /* Cluster # to stretch, 0: Create a new chain */
+    cluster_t clst /* Last cluster # of the chain to stretch, 0: Create a new chain */
 );
 void fat_remove_chain(
     cluster_t clst, /* Cluster # to be removed */
@@ -33,6 +38,12 @@ void fat_remove_chain(
 );
 cluster_t fat_get(cluster_t clst);
 void fat_put(cluster_t clst, cluster_t val);
+bool fat_is_hole(cluster_t clst);
+void fat_set_hole(cluster_t clst, bool hole);
+size_t fat_reserve(cluster_t hint, size_t cnt, cluster_t *start);
+void fat_unreserve(cluster_t start, size_t cnt);
+void fat_chain_append(cluster_t tail, cluster_t clst);
+unsigned int fat_sectors_per_cluster(void);
 disk_sector_t cluster_to_sector(cluster_t clst);
 cluster_t sector_to_cluster(disk_sector_t sector);
 
@@ -13,6 +13,9 @@ struct file
     off_t pos;           /* Current position. */
     bool deny_write;     /* Has file_deny_write() been called? */
     int dup_cnt;
+    off_t ra_next;       /* Where a sequential read would start. */
+    off_t ra_window;     /* Bytes to read ahead, 0 if random. */
+    off_t ra_end;        /* End of the range already read ahead. */
 };
 
 /* Opening and closing files. */
@@ -28,6 +31,10 @@ off_t file_read_at(struct file *, void *, off_t size, off_t start);
 off_t file_write(struct file *, const void *, off_t);
 off_t file_write_at(struct file *, const void *, off_t size, off_t start);
 
+/* Space and durability. */
+bool file_allocate(struct file *, off_t end);
+void file_sync(struct file *);
+
 /* Preventing writes. */
 void file_deny_write(struct file *);
 void file_allow_write(struct file *);
@@ -35,6 +42,8 @@ void file_allow_write(struct file *);
 /* File position. */
 void file_seek(struct file *, off_t);
 off_t file_tell(struct file *);
+off_t file_seek_data(struct file *, off_t pos);
+off_t file_seek_hole(struct file *, off_t pos);
 off_t file_length(struct file *);
 
 #endif /* filesys/file.h */
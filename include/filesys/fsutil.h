@@ -4,7 +4,9 @@
 void fsutil_ls (char **argv);
 void fsutil_cat (char **argv);
 void fsutil_rm (char **argv);
+void fsutil_extents (char **argv);
 void fsutil_put (char **argv);
 void fsutil_get (char **argv);
+void fsutil_diskbench (char **argv);
 
 #endif /* filesys/fsutil.h */
@@ -2,6 +2,7 @@
 #define FILESYS_INODE_H
 
 #include <stdbool.h>
+#include <stddef.h>
 #include "filesys/off_t.h"
 #include "devices/disk.h"
 
@@ -9,8 +10,13 @@
 #define INODE_DIR 1
 
 struct bitmap;
+struct dir_index;
+
+/* Closed inodes kept in memory, set by the -ic kernel option. */
+extern unsigned inode_cache_limit;
 
 void inode_init(void);
+void inode_print_stats(void);
 bool inode_create(disk_sector_t, off_t, uint32_t is_dir);
 bool inode_create_link(disk_sector_t sector, char *path_name);
 
@@ -19,7 +25,17 @@ struct inode *inode_reopen(struct inode *);
 disk_sector_t inode_get_inumber(const struct inode *);
 void inode_close(struct inode *);
 void inode_remove(struct inode *);
+void inode_dir_lock(struct inode *);
+void inode_dir_unlock(struct inode *);
+struct dir_index *inode_get_dir_index(struct inode *);
+void inode_set_dir_index(struct inode *, struct dir_index *);
 off_t inode_read_at(struct inode *, void *, off_t size, off_t offset);
+void inode_readahead(struct inode *, off_t start, off_t end);
+void inode_sync(struct inode *);
+bool inode_allocate(struct inode *, off_t end);
+size_t inode_extent_cnt(struct inode *);
+off_t inode_seek_data(struct inode *, off_t pos);
+off_t inode_seek_hole(struct inode *, off_t pos);
 off_t inode_write_at(struct inode *, const void *, off_t size, off_t offset);
 void inode_deny_write(struct inode *);
 void inode_allow_write(struct inode *);
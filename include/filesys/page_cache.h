@@ -1,12 +1,28 @@
 #ifndef FILESYS_PAGE_CACHE_H
 #define FILESYS_PAGE_CACHE_H
-#include "vm/vm.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include "devices/disk.h"
+#include "filesys/off_t.h"
 
 struct page;
 enum vm_type;
 
 struct page_cache {};
 
+/* Write-behind tuning, set by the -wb-age and -wb-ratio kernel
+ * options. */
+extern unsigned page_cache_dirty_age;    /* Milliseconds. */
+extern unsigned page_cache_dirty_ratio;  /* Percent of the cache. */
+
 void page_cache_init (void);
 bool page_cache_initializer (struct page *page, enum vm_type type, void *kva);
+
+void page_cache_read (disk_sector_t, void *, off_t ofs, size_t size);
+void page_cache_write (disk_sector_t, disk_sector_t owner, const void *,
+		off_t ofs, size_t size);
+void page_cache_prefetch (disk_sector_t);
+void page_cache_flush (void);
+void page_cache_flush_owner (disk_sector_t owner);
+void page_cache_print_stats (void);
 #endif
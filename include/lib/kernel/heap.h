@@ -0,0 +1,72 @@
+#ifndef __LIB_KERNEL_HEAP_H
+#define __LIB_KERNEL_HEAP_H
+
+/* Priority queue (pairing heap).
+ *
+ * Like the doubly linked list in list.h, this heap does not
+ * require dynamically allocated memory.  Each structure that can
+ * be in a heap must embed a struct heap_elem member, and the
+ * heap_entry macro converts a struct heap_elem back to the
+ * structure that contains it.  Because no allocation is needed,
+ * the heap may be used with interrupts disabled and from
+ * interrupt handlers.
+ *
+ * The order of the heap is given by a heap_less_func supplied to
+ * heap_init(): heap_top() returns an element E such that
+ * LESS (X, E) is false for every other element X, that is, the
+ * "least" element comes out first.  Reverse the comparison to
+ * get a max-heap.
+ *
+ * Costs: heap_push() and heap_top() are O(1); heap_pop() and
+ * heap_remove() are O(log n) amortized.  None of the operations
+ * recurse, so they are safe to use on small kernel stacks.
+ *
+ * An element's key must not change while it is in a heap.  To
+ * change a key, heap_remove() the element, update the key, and
+ * heap_push() it again. */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Heap element. */
+struct heap_elem {
+	struct heap_elem *child;    /* Leftmost child. */
+	struct heap_elem *next;     /* Right sibling. */
+	struct heap_elem *prev;     /* Left sibling, or parent if leftmost. */
+};
+
+/* Compares the value of two heap elements A and B, given
+   auxiliary data AUX.  Returns true if A should leave the heap
+   before B. */
+typedef bool heap_less_func (const struct heap_elem *a,
+		const struct heap_elem *b,
+		void *aux);
+
+/* Heap. */
+struct heap {
+	struct heap_elem *root;     /* Least element, or NULL if empty. */
+	size_t size;                /* Number of elements. */
+	heap_less_func *less;       /* Comparison function. */
+	void *aux;                  /* Auxiliary data for `less'. */
+};
+
+/* Converts pointer to heap element HEAP_ELEM into a pointer to
+   the structure that HEAP_ELEM is embedded inside.  Supply the
+   name of the outer structure STRUCT and the member name MEMBER
+   of the heap element. */
+#define heap_entry(HEAP_ELEM, STRUCT, MEMBER)           \
+	((STRUCT *) ((uint8_t *) &(HEAP_ELEM)->child    \
+		- offsetof (STRUCT, MEMBER.child)))
+
+void heap_init (struct heap *, heap_less_func *, void *aux);
+
+void heap_push (struct heap *, struct heap_elem *);
+struct heap_elem *heap_top (struct heap *);
+struct heap_elem *heap_pop (struct heap *);
+void heap_remove (struct heap *, struct heap_elem *);
+
+size_t heap_size (struct heap *);
+bool heap_empty (struct heap *);
+
+#endif /* lib/kernel/heap.h */
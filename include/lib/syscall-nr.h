@@ -36,6 +36,17 @@ enum {
 
 	SYS_MOUNT,
 	SYS_UMOUNT,
+
+	SYS_FSYNC,                  /* Flush a file's data to disk. */
+	SYS_FALLOCATE,              /* Reserve disk space for a file. */
+	SYS_LSEEK,                  /* Change position, or find data/holes. */
 };
 
+/* Values of lseek()'s WHENCE argument. */
+#define SEEK_SET 0              /* OFFSET from start of file. */
+#define SEEK_CUR 1              /* OFFSET from current position. */
+#define SEEK_END 2              /* OFFSET from end of file. */
+#define SEEK_DATA 3             /* First data at or after OFFSET. */
+#define SEEK_HOLE 4             /* First hole at or after OFFSET. */
+
 #endif /* lib/syscall-nr.h */
@@ -0,0 +1,37 @@
+#ifndef THREADS_DEFERRED_H
+#define THREADS_DEFERRED_H
+
+#include <list.h>
+#include <stdbool.h>
+
+struct thread;
+
+/* Deferred work priorities.  All pending DEFERRED_HIGH items run
+   before any DEFERRED_NORMAL item. */
+enum deferred_pri
+{
+	DEFERRED_HIGH,	 /* Run as soon as possible. */
+	DEFERRED_NORMAL, /* Run when no high priority work is pending. */
+	DEFERRED_PRI_CNT
+};
+
+typedef void deferred_func(void *aux);
+
+/* A unit of work that an interrupt handler hands off to the
+   kernel worker thread, so that it runs with interrupts on. */
+struct deferred_work
+{
+	struct list_elem elem; /* Element in a worker queue. */
+	deferred_func *func;   /* Function to run. */
+	void *aux;			   /* Argument for FUNC. */
+	bool pending;		   /* Queued but not yet started? */
+};
+
+void deferred_init(void);
+void deferred_start(void);
+void deferred_work_init(struct deferred_work *, deferred_func *, void *aux);
+bool deferred_schedule(struct deferred_work *, enum deferred_pri);
+bool deferred_is_worker(const struct thread *);
+bool deferred_is_worker_ready(void);
+
+#endif /* threads/deferred.h */
@@ -0,0 +1,26 @@
+#ifndef THREADS_SWITCH_H
+#define THREADS_SWITCH_H
+
+#ifndef __ASSEMBLER__
+#include <stdint.h>
+
+/* switch_threads()'s stack frame: the callee-saved registers in
+   the order they are pushed, followed by the return address. */
+struct switch_threads_frame {
+	uint64_t r15;               /*  0: Saved %r15. */
+	uint64_t r14;               /*  8: Saved %r14. */
+	uint64_t r13;               /* 16: Saved %r13. */
+	uint64_t r12;               /* 24: Saved %r12. */
+	uint64_t rbp;               /* 32: Saved %rbp. */
+	uint64_t rbx;               /* 40: Saved %rbx. */
+	void (*rip) (void);         /* 48: Return address. */
+};
+
+/* Saves the callee-saved registers of the running thread on its
+   stack, stores its stack pointer into *CUR_RSP, then loads
+   NEXT_RSP and returns into the thread that saved it.  Returns
+   when some other thread switches back to the caller. */
+void switch_threads (uint64_t *cur_rsp, uint64_t next_rsp);
+#endif
+
+#endif /* threads/switch.h */
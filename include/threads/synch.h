@@ -1,14 +1,53 @@
 #ifndef THREADS_SYNCH_H
 #define THREADS_SYNCH_H
 
+#include <heap.h>
 #include <list.h>
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+struct thread;
+
+/* Priority wait queue.
+
+   Holds waiting threads in order of effective priority, highest
+   first, and in arrival order among threads of equal priority.
+   Waking the first waiter is O(log n).  If a waiting thread's
+   priority changes, for example through priority donation,
+   wait_queue_change_priority() moves it to its new place. */
+struct wait_queue
+{
+	struct heap heap;			 /* Elements, ordered by priority. */
+	unsigned long long next_seq; /* Arrival stamp for the next push. */
+};
+
+/* Element in a wait queue. */
+struct wait_queue_elem
+{
+	struct heap_elem elem;	   /* Heap element. */
+	struct thread *thread;	   /* Waiting thread, whose priority is the key. */
+	struct wait_queue *queue;  /* Queue holding this element, or NULL. */
+	unsigned long long seq;	   /* Arrival stamp, breaks priority ties. */
+};
+
+/* Converts pointer to wait queue element WQ_ELEM into a pointer
+   to the structure that WQ_ELEM is embedded inside. */
+#define wait_queue_entry(WQ_ELEM, STRUCT, MEMBER)   \
+	((STRUCT *)((uint8_t *)&(WQ_ELEM)->seq          \
+				- offsetof(STRUCT, MEMBER.seq)))
+
+void wait_queue_init(struct wait_queue *);
+void wait_queue_push(struct wait_queue *, struct wait_queue_elem *, struct thread *);
+struct wait_queue_elem *wait_queue_pop(struct wait_queue *);
+bool wait_queue_empty(struct wait_queue *);
+void wait_queue_change_priority(struct thread *, int priority);
 
 /* A counting semaphore. */
 struct semaphore
 {
-	unsigned value;		 /* Current value. */
-	struct list waiters; /* List of waiting threads. */
+	unsigned value;			   /* Current value. */
+	struct wait_queue waiters; /* Waiting threads. */
 };
 
 void sema_init(struct semaphore *, unsigned value);
@@ -33,7 +72,7 @@ bool lock_held_by_current_thread(const struct lock *);
 /* Condition variable. */
 struct condition
 {
-	struct list waiters; /* List of waiting threads. */
+	struct wait_queue waiters; /* Waiting threads. */
 };
 
 void cond_init(struct condition *);
@@ -41,6 +80,86 @@ void cond_wait(struct condition *, struct lock *);
 void cond_signal(struct condition *, struct lock *);
 void cond_broadcast(struct condition *, struct lock *);
 
+/* Readers-writer lock.
+
+   Any number of readers may hold the lock at once, or a single
+   writer.  Writers take precedence: once a writer is waiting, no
+   new reader gets in until it is done, and a writer that lets go
+   while another is queued hands the lock to it.  A writer holds
+   or waits for WRITE_LOCK for as long as it owns the rwlock, so
+   writers and readers that are waiting for a writer donate their
+   priority to it.  A writer that is waiting for the readers to
+   leave donates its priority to each of them in turn. */
+struct rwlock
+{
+	struct lock write_lock;		/* Owned by the current or next writer. */
+	struct lock mutex;			/* Protects the members below. */
+	struct condition no_readers; /* Signaled when READERS drops to 0. */
+	struct condition writer_in;	/* Signaled when a writer gets WRITE_LOCK. */
+	unsigned readers;			/* # of readers holding the lock. */
+	unsigned writers_queued;	/* # of writers waiting for WRITE_LOCK. */
+	bool writer;				/* A writer owns WRITE_LOCK. */
+	struct list reader_list;	/* Holders' struct rwlock_reader. */
+	struct thread *waiting_writer; /* Writer waiting for READERS to be 0. */
+};
+
+/* Most rwlocks that one thread may hold for reading at once. */
+#define RWLOCK_READ_MAX 4
+
+/* A thread's hold on an rwlock for reading, kept in the thread so
+   that a waiting writer can find the readers to donate to. */
+struct rwlock_reader
+{
+	struct rwlock *rw;			/* Rwlock held, or NULL if unused. */
+	struct thread *thread;		/* Holding thread. */
+	struct list_elem elem;		/* Element in RW's reader_list. */
+};
+
+void rwlock_init(struct rwlock *);
+void rwlock_read_acquire(struct rwlock *);
+void rwlock_read_release(struct rwlock *);
+void rwlock_write_acquire(struct rwlock *);
+void rwlock_write_release(struct rwlock *);
+bool rwlock_write_held_by_current_thread(const struct rwlock *);
+void rwlock_donate(struct rwlock *, int priority);
+int rwlock_donated_priority(const struct thread *);
+
+/* Sequence lock.
+
+   Protects a small value that is read often and written rarely,
+   such as a tick counter, without making readers block writers.
+   A writer bumps SEQ to an odd value before writing and to an
+   even value after.  A reader samples SEQ with
+   seqlock_read_begin(), copies the value, and retries if
+   seqlock_read_retry() says that a write overlapped the copy.
+
+   Writers must hold interrupts off for the whole write, and must
+   exclude each other by some other means. */
+struct seqlock
+{
+	volatile unsigned seq; /* Odd while a write is in progress. */
+};
+
+void seqlock_init(struct seqlock *);
+unsigned seqlock_read_begin(const struct seqlock *);
+bool seqlock_read_retry(const struct seqlock *, unsigned start);
+void seqlock_write_begin(struct seqlock *);
+void seqlock_write_end(struct seqlock *);
+
+/* Spinlock.
+
+   Protects data that may be touched by more than one CPU.  It
+   must be held only with interrupts disabled, which is also what
+   keeps the holder from being preempted on its own CPU. */
+struct spinlock
+{
+	volatile unsigned locked; /* Nonzero while held. */
+};
+
+void spin_init(struct spinlock *);
+void spin_lock(struct spinlock *);
+void spin_unlock(struct spinlock *);
+
 /* Optimization barrier.
  *
  * The compiler will not reorder operations across an
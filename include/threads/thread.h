@@ -2,6 +2,7 @@
 #define THREADS_THREAD_H
 
 #include <debug.h>
+#include <heap.h>
 #include <list.h>
 #include <stdint.h>
 #include "threads/interrupt.h"
@@ -100,19 +101,25 @@ struct thread
 	int priority;			   /* Priority. */
 
 	/* Shared between thread.c and synch.c. */
-	struct list_elem elem; /* List element. */
+	struct list_elem elem;				/* List element. */
+	struct wait_queue_elem wait_elem;	/* Element in a semaphore's wait queue. */
+	struct wait_queue_elem *cond_elem;	/* Element in a condition's wait queue. */
 
 	/**************** project 1: threads *******************/
 	int64_t wakeup_tick;
+	struct heap_elem sleep_elem; /* Element in the sleep queue. */
 
 	int init_priority;
 
 	struct lock *wait_on_lock;
 	struct list donations;
 	struct list_elem donation_elem;
+	struct rwlock *wait_on_readers;	/* Rwlock whose readers we wait out. */
+	struct rwlock_reader read_holds[RWLOCK_READ_MAX]; /* Rwlocks read. */
 
 	int nice;
 	int recent_cpu;
+	int64_t recent_cpu_epoch; /* Decay epoch recent_cpu is current for. */
 	struct list_elem all_elem;
 
 	/**************** project 2: userprog *******************/
@@ -152,7 +159,8 @@ struct thread
 #endif
 
 	/* Owned by thread.c. */
-	struct intr_frame tf; /* Information for switching */
+	struct intr_frame tf; /* Information for the first launch */
+	uint64_t switch_rsp;  /* Saved stack pointer for switch_threads(). */
 	unsigned magic;		  /* Detects stack overflow. */
 };
 
@@ -184,6 +192,7 @@ int thread_get_priority(void);
 void thread_set_priority(int);
 
 void donate_priority(void);
+void donate_priority_to(struct thread *, int priority);
 void remove_with_lock(struct lock *lock);
 void refresh_priority(void);
 
@@ -191,8 +200,9 @@ void mlfqs_priority(struct thread *t);
 void mlfqs_recent_cpu(struct thread *t);
 void mlfqs_load_avg(void);
 void mlfqs_increment(void);
-void mlfqs_recalc_recent_cpu(void);
-void mlfqs_recalc_priority(void);
+void mlfqs_decay(void);
+void mlfqs_update_current(void);
+void mlfqs_refresh_ready(void);
 
 int thread_get_nice(void);
 void thread_set_nice(int);
@@ -206,6 +216,5 @@ void thread_awake(int64_t ticks);
 void update_next_tick_to_awake(int64_t ticks);
 int64_t get_next_tick_to_awake(void);
 void test_max_priority(void);
-bool cmp_priority(const struct list_elem *a, const struct list_elem *b, void *aux UNUSED);
 
 #endif /* threads/thread.h */
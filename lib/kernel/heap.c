@@ -0,0 +1,173 @@
+#include "heap.h"
+#include "../debug.h"
+
+/* A pairing heap is a multiway tree in which every node is
+   "less" than (comes out before) all of its children.  Each node
+   points to its leftmost child, and the children of a node form a
+   doubly linked sibling list through `next' and `prev'.  The
+   leftmost child's `prev' points to the parent instead, which
+   lets an arbitrary element unlink itself in O(1).
+
+   Two heaps are melded by making the root that comes out later
+   the leftmost child of the other one.  Popping the root melds
+   its children pairwise from left to right, then melds the
+   resulting trees together from right to left; this "two-pass"
+   scheme is what gives the O(log n) amortized bound. */
+
+static struct heap_elem *meld (struct heap *, struct heap_elem *,
+		struct heap_elem *);
+static struct heap_elem *merge_pairs (struct heap *, struct heap_elem *);
+
+/* Initializes HEAP as an empty heap ordered by LESS, given
+   auxiliary data AUX. */
+void
+heap_init (struct heap *heap, heap_less_func *less, void *aux) {
+	ASSERT (heap != NULL);
+	ASSERT (less != NULL);
+
+	heap->root = NULL;
+	heap->size = 0;
+	heap->less = less;
+	heap->aux = aux;
+}
+
+/* Inserts ELEM into HEAP. */
+void
+heap_push (struct heap *heap, struct heap_elem *elem) {
+	ASSERT (heap != NULL);
+	ASSERT (elem != NULL);
+
+	elem->child = elem->next = elem->prev = NULL;
+	heap->root = meld (heap, heap->root, elem);
+	heap->size++;
+}
+
+/* Returns the least element in HEAP without removing it.
+   Undefined behavior if HEAP is empty. */
+struct heap_elem *
+heap_top (struct heap *heap) {
+	ASSERT (!heap_empty (heap));
+
+	return heap->root;
+}
+
+/* Removes and returns the least element in HEAP.
+   Undefined behavior if HEAP is empty. */
+struct heap_elem *
+heap_pop (struct heap *heap) {
+	struct heap_elem *root;
+
+	ASSERT (!heap_empty (heap));
+
+	root = heap->root;
+	heap->root = merge_pairs (heap, root->child);
+	root->child = NULL;
+	heap->size--;
+	return root;
+}
+
+/* Removes ELEM, which must be in HEAP, from HEAP. */
+void
+heap_remove (struct heap *heap, struct heap_elem *elem) {
+	struct heap_elem *subtree;
+
+	ASSERT (!heap_empty (heap));
+	ASSERT (elem != NULL);
+
+	if (elem == heap->root) {
+		heap_pop (heap);
+		return;
+	}
+
+	/* Unlink ELEM from its parent or left sibling. */
+	if (elem->prev->child == elem)
+		elem->prev->child = elem->next;
+	else
+		elem->prev->next = elem->next;
+	if (elem->next != NULL)
+		elem->next->prev = elem->prev;
+	elem->next = elem->prev = NULL;
+
+	/* Put ELEM's children back into the heap. */
+	subtree = merge_pairs (heap, elem->child);
+	elem->child = NULL;
+	heap->root = meld (heap, heap->root, subtree);
+	heap->size--;
+}
+
+/* Returns the number of elements in HEAP. */
+size_t
+heap_size (struct heap *heap) {
+	ASSERT (heap != NULL);
+
+	return heap->size;
+}
+
+/* Returns true if HEAP is empty, false otherwise. */
+bool
+heap_empty (struct heap *heap) {
+	ASSERT (heap != NULL);
+
+	return heap->root == NULL;
+}
+
+/* Melds the trees rooted at A and B, either of which may be
+   null, and returns the root of the result.  A and B must not
+   have siblings. */
+static struct heap_elem *
+meld (struct heap *heap, struct heap_elem *a, struct heap_elem *b) {
+	if (a == NULL)
+		return b;
+	if (b == NULL)
+		return a;
+
+	if (heap->less (b, a, heap->aux)) {
+		struct heap_elem *tmp = a;
+		a = b;
+		b = tmp;
+	}
+
+	/* Make B the leftmost child of A. */
+	b->prev = a;
+	b->next = a->child;
+	if (a->child != NULL)
+		a->child->prev = b;
+	a->child = b;
+	return a;
+}
+
+/* Melds the sibling list starting at FIRST into a single tree
+   and returns its root, or a null pointer if FIRST is null. */
+static struct heap_elem *
+merge_pairs (struct heap *heap, struct heap_elem *first) {
+	struct heap_elem *pairs = NULL;
+	struct heap_elem *result = NULL;
+
+	/* First pass: meld siblings in pairs from left to right,
+	   stacking the results through their `next' links. */
+	while (first != NULL) {
+		struct heap_elem *a = first;
+		struct heap_elem *b = first->next;
+		struct heap_elem *m;
+
+		first = b != NULL ? b->next : NULL;
+		a->next = a->prev = NULL;
+		if (b != NULL)
+			b->next = b->prev = NULL;
+
+		m = meld (heap, a, b);
+		m->next = pairs;
+		pairs = m;
+	}
+
+	/* Second pass: meld the stacked trees, which pops them from
+	   right to left. */
+	while (pairs != NULL) {
+		struct heap_elem *next = pairs->next;
+
+		pairs->next = NULL;
+		result = meld (heap, pairs, result);
+		pairs = next;
+	}
+	return result;
+}
@@ -145,6 +145,21 @@ dup2 (int oldfd, int newfd){
 	return syscall2 (SYS_DUP2, oldfd, newfd);
 }
 
+int
+fsync (int fd) {
+	return syscall1 (SYS_FSYNC, fd);
+}
+
+int
+fallocate (int fd, off_t offset, off_t len) {
+	return syscall3 (SYS_FALLOCATE, fd, offset, len);
+}
+
+off_t
+lseek (int fd, off_t offset, int whence) {
+	return syscall3 (SYS_LSEEK, fd, offset, whence);
+}
+
 void *
 mmap (void *addr, size_t length, int writable, int fd, off_t offset) {
 	return (void *) syscall5 (SYS_MMAP, addr, length, writable, fd, offset);
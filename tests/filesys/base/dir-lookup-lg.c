@@ -0,0 +1,90 @@
+/* Creates 10,000 files in one directory, opens them by name in
+   random order, checks that readdir returns them in the order
+   they were created, then removes every other one and checks that
+   exactly those are gone.  Each lookup is cheap only if the file
+   system does not read the directory entry by entry to find a
+   name, so this test doubles as a benchmark for that. */
+
+#include <random.h>
+#include <stdio.h>
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define FILE_CNT 10000
+
+static unsigned order[FILE_CNT];
+
+/* Stores the path of file IDX into NAME. */
+static void
+file_name (char name[32], unsigned idx) 
+{
+  snprintf (name, 32, "big/f%u", idx);
+}
+
+void
+test_main (void) 
+{
+  char name[32];
+  char entry[READDIR_MAX_LEN + 1];
+  unsigned i;
+  int fd;
+
+  CHECK (mkdir ("big"), "mkdir \"big\"");
+
+  msg ("create %d files in \"big\"", FILE_CNT);
+  for (i = 0; i < FILE_CNT; i++) 
+    {
+      file_name (name, i);
+      if (!create (name, 0))
+        fail ("create \"%s\" failed", name);
+    }
+
+  msg ("open each file in random order");
+  for (i = 0; i < FILE_CNT; i++)
+    order[i] = i;
+  random_init (0);
+  shuffle (order, FILE_CNT, sizeof *order);
+  for (i = 0; i < FILE_CNT; i++) 
+    {
+      file_name (name, order[i]);
+      if ((fd = open (name)) < 2)
+        fail ("open \"%s\" failed", name);
+      close (fd);
+    }
+  if ((fd = open ("big/f10000")) >= 2)
+    fail ("open \"big/f10000\" should have failed");
+
+  msg ("read \"big\" in order");
+  CHECK ((fd = open ("big")) > 1, "open \"big\"");
+  for (i = 0; readdir (fd, entry); i++) 
+    {
+      file_name (name, i);
+      if (i >= FILE_CNT || strcmp (entry, name + strlen ("big/")))
+        fail ("readdir returned \"%s\" as entry %u", entry, i);
+    }
+  if (i != FILE_CNT)
+    fail ("readdir returned %u entries, expected %d", i, FILE_CNT);
+  msg ("close \"big\"");
+  close (fd);
+
+  msg ("remove every other file");
+  for (i = 0; i < FILE_CNT; i += 2) 
+    {
+      file_name (name, i);
+      if (!remove (name))
+        fail ("remove \"%s\" failed", name);
+    }
+
+  msg ("open each file again");
+  for (i = 0; i < FILE_CNT; i++) 
+    {
+      file_name (name, i);
+      fd = open (name);
+      if ((fd > 1) != (i % 2 == 1))
+        fail ("open \"%s\" returned %d", name, fd);
+      if (fd > 1)
+        close (fd);
+    }
+}
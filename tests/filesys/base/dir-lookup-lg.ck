@@ -0,0 +1,17 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(dir-lookup-lg) begin
+(dir-lookup-lg) mkdir "big"
+(dir-lookup-lg) create 10000 files in "big"
+(dir-lookup-lg) open each file in random order
+(dir-lookup-lg) read "big" in order
+(dir-lookup-lg) open "big"
+(dir-lookup-lg) close "big"
+(dir-lookup-lg) remove every other file
+(dir-lookup-lg) open each file again
+(dir-lookup-lg) end
+EOF
+pass;
@@ -0,0 +1,69 @@
+/* Builds a chain of nested directories, then opens a file at the
+   bottom by its full path many times, and a name that does not
+   exist just as often.  Then removes and recreates the file and
+   a directory on the path, checking that every open sees the
+   change.  Repeated opens are cheap only if the file system
+   remembers path components it has already looked up, so this
+   test doubles as a benchmark for that. */
+
+#include <stdio.h>
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define DEPTH 8
+#define OPEN_CNT 1000
+
+static char path[160];
+static char missing[160];
+
+/* Opens NAME OPEN_CNT times, expecting it to be there if EXISTS
+   and missing otherwise. */
+static void
+open_many (const char *name, bool exists) 
+{
+  int i;
+
+  for (i = 0; i < OPEN_CNT; i++) 
+    {
+      int fd = open (name);
+      if ((fd > 1) != exists)
+        fail ("open \"%s\" returned %d", name, fd);
+      if (fd > 1)
+        close (fd);
+    }
+}
+
+void
+test_main (void) 
+{
+  char dir[128] = "";
+  int i;
+
+  for (i = 0; i < DEPTH; i++) 
+    {
+      snprintf (dir + strlen (dir), sizeof dir - strlen (dir), "/d%d", i);
+      CHECK (mkdir (dir), "mkdir \"%s\"", dir);
+    }
+  snprintf (path, sizeof path, "%s/file", dir);
+  snprintf (missing, sizeof missing, "%s/nothing", dir);
+  CHECK (create (path, 0), "create \"%s\"", path);
+
+  msg ("open \"%s\" %d times", path, OPEN_CNT);
+  open_many (path, true);
+  msg ("open \"%s\" %d times", missing, OPEN_CNT);
+  open_many (missing, false);
+
+  CHECK (remove (path), "remove \"%s\"", path);
+  open_many (path, false);
+  CHECK (create (missing, 0), "create \"%s\"", missing);
+  open_many (missing, true);
+  CHECK (remove (missing), "remove \"%s\"", missing);
+
+  CHECK (remove (dir), "remove \"%s\"", dir);
+  open_many (path, false);
+  CHECK (mkdir (dir), "mkdir \"%s\"", dir);
+  CHECK (create (path, 0), "create \"%s\"", path);
+  open_many (path, true);
+}
@@ -0,0 +1,26 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(dir-open-deep) begin
+(dir-open-deep) mkdir "/d0"
+(dir-open-deep) mkdir "/d0/d1"
+(dir-open-deep) mkdir "/d0/d1/d2"
+(dir-open-deep) mkdir "/d0/d1/d2/d3"
+(dir-open-deep) mkdir "/d0/d1/d2/d3/d4"
+(dir-open-deep) mkdir "/d0/d1/d2/d3/d4/d5"
+(dir-open-deep) mkdir "/d0/d1/d2/d3/d4/d5/d6"
+(dir-open-deep) mkdir "/d0/d1/d2/d3/d4/d5/d6/d7"
+(dir-open-deep) create "/d0/d1/d2/d3/d4/d5/d6/d7/file"
+(dir-open-deep) open "/d0/d1/d2/d3/d4/d5/d6/d7/file" 1000 times
+(dir-open-deep) open "/d0/d1/d2/d3/d4/d5/d6/d7/nothing" 1000 times
+(dir-open-deep) remove "/d0/d1/d2/d3/d4/d5/d6/d7/file"
+(dir-open-deep) create "/d0/d1/d2/d3/d4/d5/d6/d7/nothing"
+(dir-open-deep) remove "/d0/d1/d2/d3/d4/d5/d6/d7/nothing"
+(dir-open-deep) remove "/d0/d1/d2/d3/d4/d5/d6/d7"
+(dir-open-deep) mkdir "/d0/d1/d2/d3/d4/d5/d6/d7"
+(dir-open-deep) create "/d0/d1/d2/d3/d4/d5/d6/d7/file"
+(dir-open-deep) end
+EOF
+pass;
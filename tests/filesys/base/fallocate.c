@@ -0,0 +1,38 @@
+/* Reserves space for a file with fallocate, checks that its
+   length did not change, then fills the reserved space and reads
+   it back.  Also checks that fallocate rejects bad arguments. */
+
+#include <random.h>
+#include <stdio.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define TEST_SIZE 65536
+
+static char buf[TEST_SIZE];
+
+void
+test_main (void) 
+{
+  const char *file_name = "data";
+  int fd;
+
+  CHECK (create (file_name, 0), "create \"%s\"", file_name);
+  CHECK ((fd = open (file_name)) > 1, "open \"%s\"", file_name);
+
+  CHECK (fallocate (fd, 0, TEST_SIZE) == 0, "fallocate \"%s\"", file_name);
+  CHECK (filesize (fd) == 0, "filesize \"%s\" is still 0", file_name);
+
+  CHECK (fallocate (fd, 0, 0) == -1, "fallocate of 0 bytes must fail");
+  CHECK (fallocate (fd, -1, 512) == -1, "fallocate at offset -1 must fail");
+  CHECK (fallocate (STDIN_FILENO, 0, 512) == -1,
+         "fallocate stdin must fail");
+  CHECK (fallocate (1234, 0, 512) == -1, "fallocate bad fd must fail");
+
+  random_bytes (buf, sizeof buf);
+  CHECK (write (fd, buf, sizeof buf) == sizeof buf, "write \"%s\"", file_name);
+  msg ("close \"%s\"", file_name);
+  close (fd);
+  check_file (file_name, buf, sizeof buf);
+}
@@ -0,0 +1,22 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(fallocate) begin
+(fallocate) create "data"
+(fallocate) open "data"
+(fallocate) fallocate "data"
+(fallocate) filesize "data" is still 0
+(fallocate) fallocate of 0 bytes must fail
+(fallocate) fallocate at offset -1 must fail
+(fallocate) fallocate stdin must fail
+(fallocate) fallocate bad fd must fail
+(fallocate) write "data"
+(fallocate) close "data"
+(fallocate) open "data" for verification
+(fallocate) verified contents of "data"
+(fallocate) close "data"
+(fallocate) end
+EOF
+pass;
@@ -0,0 +1,38 @@
+/* Writes a file, fsyncs it, and checks that by the time fsync
+   returns its data has reached the disk.  Also checks that fsync
+   fails on descriptors that do not name files. */
+
+#include <random.h>
+#include <stdio.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define TEST_SIZE 4096
+
+static char buf[TEST_SIZE];
+
+void
+test_main (void) 
+{
+  const char *file_name = "data";
+  long long write_cnt;
+  int fd;
+
+  CHECK (create (file_name, 0), "create \"%s\"", file_name);
+  CHECK ((fd = open (file_name)) > 1, "open \"%s\"", file_name);
+  random_bytes (buf, sizeof buf);
+
+  write_cnt = get_fs_disk_write_cnt ();
+  CHECK (write (fd, buf, sizeof buf) == sizeof buf, "write \"%s\"", file_name);
+  CHECK (fsync (fd) == 0, "fsync \"%s\"", file_name);
+  CHECK (get_fs_disk_write_cnt () >= write_cnt + TEST_SIZE / 512,
+         "check write_cnt");
+
+  CHECK (fsync (STDIN_FILENO) == -1, "fsync stdin must fail");
+  CHECK (fsync (1234) == -1, "fsync bad fd must fail");
+
+  msg ("close \"%s\"", file_name);
+  close (fd);
+  check_file (file_name, buf, sizeof buf);
+}
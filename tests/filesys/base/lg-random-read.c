@@ -0,0 +1,70 @@
+/* Writes a 4 MB file, then reads 512-byte blocks from it at
+   random offsets, checking that each one holds what was written.
+   Blocks near the end of the file are as cheap to locate as those
+   near the start only if the file system does not walk the
+   cluster chain from the beginning on every access, so this test
+   doubles as a benchmark for that. */
+
+#include <random.h>
+#include <stdio.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define BLOCK_SIZE 512
+#define BLOCK_CNT 8192                  /* 4 MB. */
+#define CHUNK_BLOCKS 8
+#define READ_CNT 4096
+
+static int chunk[CHUNK_BLOCKS * BLOCK_SIZE / sizeof (int)];
+static int block[BLOCK_SIZE / sizeof (int)];
+
+/* Fills the BLOCK_SIZE bytes at P with block number IDX. */
+static void
+stamp (int *p, int idx) 
+{
+  size_t i;
+
+  for (i = 0; i < BLOCK_SIZE / sizeof *p; i++)
+    p[i] = idx;
+}
+
+void
+test_main (void) 
+{
+  const char *file_name = "bigfile";
+  int fd;
+  size_t i, j;
+
+  CHECK (create (file_name, 0), "create \"%s\"", file_name);
+  CHECK ((fd = open (file_name)) > 1, "open \"%s\"", file_name);
+
+  msg ("write \"%s\"", file_name);
+  for (i = 0; i < BLOCK_CNT; i += CHUNK_BLOCKS) 
+    {
+      for (j = 0; j < CHUNK_BLOCKS; j++)
+        stamp (chunk + j * BLOCK_SIZE / sizeof (int), i + j);
+      if (write (fd, chunk, sizeof chunk) != sizeof chunk)
+        fail ("write %zu bytes at offset %zu failed",
+              sizeof chunk, i * BLOCK_SIZE);
+    }
+
+  msg ("read \"%s\" at random offsets", file_name);
+  random_init (0);
+  for (i = 0; i < READ_CNT; i++) 
+    {
+      size_t idx = random_ulong () % BLOCK_CNT;
+      size_t k;
+
+      seek (fd, idx * BLOCK_SIZE);
+      if (read (fd, block, BLOCK_SIZE) != BLOCK_SIZE)
+        fail ("read %d bytes at offset %zu failed",
+              BLOCK_SIZE, idx * BLOCK_SIZE);
+      for (k = 0; k < BLOCK_SIZE / sizeof *block; k++)
+        if (block[k] != (int) idx)
+          fail ("block %zu holds %d, expected %zu", idx, block[k], idx);
+    }
+
+  msg ("close \"%s\"", file_name);
+  close (fd);
+}
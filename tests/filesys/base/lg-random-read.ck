@@ -0,0 +1,14 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(lg-random-read) begin
+(lg-random-read) create "bigfile"
+(lg-random-read) open "bigfile"
+(lg-random-read) write "bigfile"
+(lg-random-read) read "bigfile" at random offsets
+(lg-random-read) close "bigfile"
+(lg-random-read) end
+EOF
+pass;
@@ -0,0 +1,38 @@
+/* Spawns 4 child processes, each of which reads its own file
+   over and over and makes sure that the contents are what they
+   should be.  Because the children never touch the same file,
+   their reads should proceed in parallel in the file system. */
+
+#include <random.h>
+#include <stdio.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+#include "tests/filesys/base/par-read.h"
+
+static char buf[BUF_SIZE];
+
+void
+test_main (void) 
+{
+  pid_t children[CHILD_CNT];
+  size_t i;
+
+  for (i = 0; i < CHILD_CNT; i++) 
+    {
+      char file_name[16];
+      int fd;
+
+      snprintf (file_name, sizeof file_name, "data%zu", i);
+      CHECK (create (file_name, sizeof buf), "create \"%s\"", file_name);
+      CHECK ((fd = open (file_name)) > 1, "open \"%s\"", file_name);
+      random_init (i);
+      random_bytes (buf, sizeof buf);
+      CHECK (write (fd, buf, sizeof buf) > 0, "write \"%s\"", file_name);
+      msg ("close \"%s\"", file_name);
+      close (fd);
+    }
+
+  exec_children ("child-par-read", children, CHILD_CNT);
+  wait_children (children, CHILD_CNT);
+}
@@ -0,0 +1,9 @@
+#ifndef TESTS_FILESYS_BASE_PAR_READ_H
+#define TESTS_FILESYS_BASE_PAR_READ_H
+
+#define CHILD_CNT 4
+#define BUF_SIZE 16384
+#define CHUNK_SIZE 512
+#define PASS_CNT 8
+
+#endif /* tests/filesys/base/par-read.h */
@@ -0,0 +1,71 @@
+/* Creates a 4 MB file that has never been written, checks that it
+   reads as zeros and is one hole, then writes a few bytes in the
+   middle and checks that lseek() with SEEK_DATA and SEEK_HOLE
+   finds exactly the cluster that holds them.  Assumes the default
+   cluster size of one sector. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define FILE_SIZE (4 * 1024 * 1024)
+#define CLUSTER 512
+#define DATA_OFS (FILE_SIZE / 2 + 100)
+
+static char buf[CLUSTER];
+
+void
+test_main (void) 
+{
+  const char *file_name = "sparse";
+  size_t i;
+  int fd;
+
+  CHECK (create (file_name, FILE_SIZE), "create \"%s\"", file_name);
+  CHECK ((fd = open (file_name)) > 1, "open \"%s\"", file_name);
+  CHECK (filesize (fd) == FILE_SIZE, "filesize \"%s\" is %d",
+         file_name, FILE_SIZE);
+
+  msg ("read \"%s\" as zeros", file_name);
+  seek (fd, DATA_OFS);
+  if (read (fd, buf, sizeof buf) != sizeof buf)
+    fail ("read %zu bytes at offset %d failed", sizeof buf, DATA_OFS);
+  for (i = 0; i < sizeof buf; i++)
+    if (buf[i] != 0)
+      fail ("byte %zu of hole is %d, not 0", DATA_OFS + i, buf[i]);
+
+  CHECK (lseek (fd, 0, SEEK_DATA) == -1, "no data in \"%s\"", file_name);
+  CHECK (lseek (fd, 0, SEEK_HOLE) == 0, "hole at start of \"%s\"",
+         file_name);
+
+  msg ("write \"%s\" at offset %d", file_name, DATA_OFS);
+  seek (fd, DATA_OFS);
+  if (write (fd, "data", 4) != 4)
+    fail ("write 4 bytes at offset %d failed", DATA_OFS);
+
+  CHECK (lseek (fd, 0, SEEK_DATA) == FILE_SIZE / 2,
+         "data starts at offset %d", FILE_SIZE / 2);
+  CHECK (lseek (fd, DATA_OFS, SEEK_DATA) == DATA_OFS,
+         "data at offset %d", DATA_OFS);
+  CHECK (lseek (fd, FILE_SIZE / 2, SEEK_HOLE) == FILE_SIZE / 2 + CLUSTER,
+         "hole resumes at offset %d", FILE_SIZE / 2 + CLUSTER);
+  CHECK (lseek (fd, FILE_SIZE / 2 + CLUSTER, SEEK_DATA) == -1,
+         "no data after offset %d", FILE_SIZE / 2 + CLUSTER);
+  CHECK (lseek (fd, FILE_SIZE, SEEK_HOLE) == -1,
+         "no hole at end of file");
+
+  msg ("read \"%s\" around the data", file_name);
+  seek (fd, FILE_SIZE / 2);
+  if (read (fd, buf, sizeof buf) != sizeof buf)
+    fail ("read %zu bytes at offset %d failed", sizeof buf, FILE_SIZE / 2);
+  for (i = 0; i < sizeof buf; i++)
+    {
+      char expected = i >= 100 && i < 104 ? "data"[i - 100] : 0;
+      if (buf[i] != expected)
+        fail ("byte %zu is %d, not %d", FILE_SIZE / 2 + i, buf[i], expected);
+    }
+
+  msg ("close \"%s\"", file_name);
+  close (fd);
+}
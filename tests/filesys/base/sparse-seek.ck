@@ -0,0 +1,23 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(sparse-seek) begin
+(sparse-seek) create "sparse"
+(sparse-seek) open "sparse"
+(sparse-seek) filesize "sparse" is 4194304
+(sparse-seek) read "sparse" as zeros
+(sparse-seek) no data in "sparse"
+(sparse-seek) hole at start of "sparse"
+(sparse-seek) write "sparse" at offset 2097252
+(sparse-seek) data starts at offset 2097152
+(sparse-seek) data at offset 2097252
+(sparse-seek) hole resumes at offset 2097664
+(sparse-seek) no data after offset 2097664
+(sparse-seek) no hole at end of file
+(sparse-seek) read "sparse" around the data
+(sparse-seek) close "sparse"
+(sparse-seek) end
+EOF
+pass;
@@ -0,0 +1,95 @@
+/* Creates 2,000 files of up to 400 bytes each, reads them all back
+   and checks their contents, then grows one of them well past a
+   sector and checks that its old contents survived.  Small files
+   cost one sector and one read each only if the file system keeps
+   their data in the inode, so this test doubles as a benchmark for
+   that. */
+
+#include <stdio.h>
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define FILE_CNT 2000
+#define MAX_SIZE 400
+#define GROW_SIZE 2000
+
+static char buf[GROW_SIZE];
+static char expected[GROW_SIZE];
+
+/* Returns the size of file IDX. */
+static size_t
+file_size (unsigned idx) 
+{
+  return idx * 7 % (MAX_SIZE + 1);
+}
+
+/* Fills the SIZE bytes at P with data for file IDX. */
+static void
+fill (char *p, size_t size, unsigned idx) 
+{
+  size_t i;
+
+  for (i = 0; i < size; i++)
+    p[i] = 'a' + (idx + i) % 26;
+}
+
+void
+test_main (void) 
+{
+  char name[32];
+  unsigned i;
+  int fd;
+
+  CHECK (mkdir ("tiny"), "mkdir \"tiny\"");
+
+  msg ("create %d files in \"tiny\"", FILE_CNT);
+  for (i = 0; i < FILE_CNT; i++) 
+    {
+      size_t size = file_size (i);
+
+      snprintf (name, sizeof name, "tiny/t%u", i);
+      fill (expected, size, i);
+      if (!create (name, 0))
+        fail ("create \"%s\" failed", name);
+      if ((fd = open (name)) < 2)
+        fail ("open \"%s\" failed", name);
+      if (write (fd, expected, size) != (int) size)
+        fail ("write %zu bytes to \"%s\" failed", size, name);
+      close (fd);
+    }
+
+  msg ("read back %d files", FILE_CNT);
+  for (i = 0; i < FILE_CNT; i++) 
+    {
+      size_t size = file_size (i);
+
+      snprintf (name, sizeof name, "tiny/t%u", i);
+      fill (expected, size, i);
+      if ((fd = open (name)) < 2)
+        fail ("open \"%s\" failed", name);
+      if (filesize (fd) != (int) size)
+        fail ("\"%s\" is %d bytes, expected %zu", name, filesize (fd), size);
+      if (read (fd, buf, MAX_SIZE) != (int) size)
+        fail ("read %zu bytes from \"%s\" failed", size, name);
+      if (memcmp (buf, expected, size))
+        fail ("\"%s\" holds the wrong data", name);
+      close (fd);
+    }
+
+  msg ("grow \"tiny/t57\" to %d bytes", GROW_SIZE);
+  fill (expected, GROW_SIZE, 57);
+  CHECK ((fd = open ("tiny/t57")) > 1, "open \"tiny/t57\"");
+  seek (fd, file_size (57));
+  if (write (fd, expected + file_size (57), GROW_SIZE - file_size (57))
+      != (int) (GROW_SIZE - file_size (57)))
+    fail ("write to \"tiny/t57\" failed");
+  seek (fd, 0);
+  if (read (fd, buf, GROW_SIZE) != GROW_SIZE)
+    fail ("read \"tiny/t57\" failed");
+  if (memcmp (buf, expected, GROW_SIZE))
+    fail ("\"tiny/t57\" holds the wrong data");
+  msg ("close \"tiny/t57\"");
+  close (fd);
+}
@@ -0,0 +1,15 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(tiny-files) begin
+(tiny-files) mkdir "tiny"
+(tiny-files) create 2000 files in "tiny"
+(tiny-files) read back 2000 files
+(tiny-files) grow "tiny/t57" to 2000 bytes
+(tiny-files) open "tiny/t57"
+(tiny-files) close "tiny/t57"
+(tiny-files) end
+EOF
+pass;
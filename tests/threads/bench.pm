@@ -0,0 +1,21 @@
+# Checks the output of a benchmark.  Lines that match FIGURE_RE
+# report measurements, which are not compared against anything;
+# there must be exactly FIGURE_CNT of them.  The rest of the
+# output must match EXPECTED.
+sub check_benchmark {
+    my ($figure_re, $figure_cnt, $expected) = @_;
+    our ($test);
+
+    my (@output) = read_text_file ("$test.output");
+    common_checks ("run", @output);
+
+    my ($found) = scalar (grep (/$figure_re/, @output));
+    fail "expected $figure_cnt measurements in output, found $found\n"
+      if $found != $figure_cnt;
+    @output = grep (!/$figure_re/, @output);
+
+    compare_output ("run", \@output, [$expected]);
+    pass;
+}
+
+1;
@@ -0,0 +1,92 @@
+/* Measures the cost of waking many waiters on one condition
+   variable.  500 threads of mixed priorities wait on a single
+   condition, then the main thread wakes them all with
+   cond_broadcast() and reports the cost per waiter in CPU
+   cycles.  The waiters must wake up highest priority first, and
+   in the order they started waiting among equal priorities.
+
+   Only the wakeup order is checked.  The cycle count is reported
+   so that wait queue implementations can be compared. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "devices/timer.h"
+#include "intrinsic.h"
+
+#define WAITER_CNT 500
+#define PRI_CNT (PRI_DEFAULT - PRI_MIN)
+
+static struct lock lock;
+static struct condition condition;
+static struct semaphore done;
+static int waiting_cnt;
+static int wake_order[WAITER_CNT];
+static int woken_cnt;
+
+static thread_func condvar_waiter;
+
+void
+test_condvar_broadcast (void) 
+{
+  uint64_t start, cycles;
+  int i;
+
+  /* This test does not work with the MLFQS. */
+  ASSERT (!thread_mlfqs);
+
+  lock_init (&lock);
+  cond_init (&condition);
+  sema_init (&done, 0);
+  waiting_cnt = woken_cnt = 0;
+
+  /* Every waiter has a lower priority than the main thread, so
+     none of them runs until the main thread sleeps. */
+  msg ("Starting %d waiters...", WAITER_CNT);
+  for (i = 0; i < WAITER_CNT; i++) 
+    {
+      char name[24];
+      snprintf (name, sizeof name, "waiter %d", i);
+      thread_create (name, PRI_MIN + i % PRI_CNT, condvar_waiter,
+                     (void *) (intptr_t) i);
+    }
+  while (waiting_cnt < WAITER_CNT)
+    timer_sleep (TIMER_FREQ / 10);
+
+  msg ("Broadcasting...");
+  lock_acquire (&lock);
+  start = rdtsc ();
+  cond_broadcast (&condition, &lock);
+  cycles = rdtsc () - start;
+  lock_release (&lock);
+
+  for (i = 0; i < WAITER_CNT; i++)
+    sema_down (&done);
+
+  for (i = 1; i < WAITER_CNT; i++) 
+    {
+      int a = wake_order[i - 1];
+      int b = wake_order[i];
+      if (a % PRI_CNT < b % PRI_CNT
+          || (a % PRI_CNT == b % PRI_CNT && a > b))
+        fail ("waiter %d woke up before waiter %d", a, b);
+    }
+  msg ("All waiters woke up in order.");
+  msg ("%llu cycles per waiter.",
+       (unsigned long long) cycles / WAITER_CNT);
+}
+
+static void
+condvar_waiter (void *id_) 
+{
+  int id = (intptr_t) id_;
+
+  lock_acquire (&lock);
+  waiting_cnt++;
+  cond_wait (&condition, &lock);
+  wake_order[woken_cnt++] = id;
+  lock_release (&lock);
+  sema_up (&done);
+}
@@ -0,0 +1,13 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+use tests::threads::bench;
+check_benchmark (qr/^\(condvar-broadcast\) \d+ cycles per waiter\.$/, 1,
+		 <<'EOF');
+(condvar-broadcast) begin
+(condvar-broadcast) Starting 500 waiters...
+(condvar-broadcast) Broadcasting...
+(condvar-broadcast) All waiters woke up in order.
+(condvar-broadcast) end
+EOF
@@ -0,0 +1,99 @@
+/* Shows whether the cost of the MLFQS bookkeeping done in the
+   timer interrupt grows with the number of threads.
+
+   The main thread counts how many iterations of a busy loop it
+   completes in one second.  It then creates 1,000 threads that
+   each sleep for a second, which makes them miss a recent_cpu
+   decay, and then block on a semaphore.  With all of them
+   blocked, the main thread counts its iterations again.  If every
+   tick, or every fourth tick, walked all of the threads, the
+   timer interrupt would eat most of the CPU and the second count
+   would come out far below the first.  Both counts are reported
+   without being checked.
+
+   Finally the threads are released and waited for, which makes
+   each of them catch up on the decays it missed while blocked. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/malloc.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "devices/timer.h"
+
+#define THREAD_CNT 1000
+
+static struct semaphore wait_sema;
+static struct semaphore done_sema;
+
+static void stress_thread (void *aux);
+static long long spin_one_second (void);
+
+void
+test_mlfqs_stress (void) 
+{
+  long long before, after;
+  int i;
+
+  ASSERT (thread_mlfqs);
+
+  sema_init (&wait_sema, 0);
+  sema_init (&done_sema, 0);
+
+  msg ("Measuring throughput with no other threads...");
+  before = spin_one_second ();
+  msg ("%lld iterations per second.", before);
+
+  msg ("Creating %d threads...", THREAD_CNT);
+  for (i = 0; i < THREAD_CNT; i++) 
+    {
+      char name[16];
+      snprintf (name, sizeof name, "stress %d", i);
+      if (thread_create (name, PRI_DEFAULT, stress_thread, NULL)
+          == TID_ERROR)
+        fail ("thread_create() failed for thread %d", i);
+    }
+
+  /* Let every thread go to sleep, miss a decay, and block. */
+  timer_sleep (3 * TIMER_FREQ);
+
+  msg ("Measuring throughput with %d blocked threads...", THREAD_CNT);
+  after = spin_one_second ();
+  msg ("%lld iterations per second.", after);
+
+  msg ("Releasing threads...");
+  for (i = 0; i < THREAD_CNT; i++)
+    sema_up (&wait_sema);
+  for (i = 0; i < THREAD_CNT; i++)
+    sema_down (&done_sema);
+  msg ("All threads finished.");
+}
+
+static void
+stress_thread (void *aux UNUSED) 
+{
+  timer_sleep (TIMER_FREQ);
+  sema_down (&wait_sema);
+  if (thread_get_recent_cpu () < 0)
+    fail ("recent_cpu went negative");
+  sema_up (&done_sema);
+}
+
+/* Spins for one second, starting at a tick boundary, and returns
+   the number of loop iterations completed. */
+static long long
+spin_one_second (void) 
+{
+  long long iterations = 0;
+  int64_t start_time;
+
+  start_time = timer_ticks ();
+  while (timer_elapsed (start_time) == 0)
+    continue;
+
+  start_time = timer_ticks ();
+  while (timer_elapsed (start_time) < TIMER_FREQ)
+    iterations++;
+  return iterations;
+}
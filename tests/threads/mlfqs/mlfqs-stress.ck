@@ -0,0 +1,15 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+use tests::threads::bench;
+check_benchmark (qr/^\(mlfqs-stress\) \d+ iterations per second\.$/, 2,
+		 <<'EOF');
+(mlfqs-stress) begin
+(mlfqs-stress) Measuring throughput with no other threads...
+(mlfqs-stress) Creating 1000 threads...
+(mlfqs-stress) Measuring throughput with 1000 blocked threads...
+(mlfqs-stress) Releasing threads...
+(mlfqs-stress) All threads finished.
+(mlfqs-stress) end
+EOF
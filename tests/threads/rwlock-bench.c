@@ -0,0 +1,89 @@
+/* Compares reader throughput of struct lock and struct rwlock.
+   Eight threads repeatedly take the lock, sleep for one tick
+   while holding it, and let go, for one second each with a
+   struct lock and then with a struct rwlock taken for reading.
+   Only one thread at a time can sleep in the critical section
+   with a struct lock, but with a rwlock all of them can.
+
+   Since every critical section lasts about one tick, a struct
+   lock lets about one reader through per tick and a rwlock about
+   READER_CNT, whatever the host.  The rwlock must get at least
+   READER_CNT / 2 times as many readers through. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "devices/timer.h"
+
+#define READER_CNT 8
+
+static struct lock lock;
+static struct rwlock rwlock;
+static struct semaphore done;
+static bool use_rwlock;
+static int64_t start_time;
+static long long section_cnt;
+
+static thread_func reader_thread;
+static long long run_readers (bool rw);
+
+void
+test_rwlock_bench (void) 
+{
+  long long lock_cnt, rwlock_cnt;
+
+  lock_init (&lock);
+  rwlock_init (&rwlock);
+  sema_init (&done, 0);
+
+  msg ("Running %d readers with struct lock...", READER_CNT);
+  lock_cnt = run_readers (false);
+  msg ("Running %d readers with struct rwlock...", READER_CNT);
+  rwlock_cnt = run_readers (true);
+
+  msg ("struct lock: %lld reads per second.", lock_cnt);
+  msg ("struct rwlock: %lld reads per second.", rwlock_cnt);
+  if (rwlock_cnt < lock_cnt * READER_CNT / 2)
+    fail ("rwlock let %lld readers through, struct lock %lld",
+          rwlock_cnt, lock_cnt);
+}
+
+/* Runs READER_CNT readers for one second and returns the number
+   of critical sections they completed. */
+static long long
+run_readers (bool rw) 
+{
+  int i;
+
+  use_rwlock = rw;
+  section_cnt = 0;
+  start_time = timer_ticks ();
+  for (i = 0; i < READER_CNT; i++)
+    thread_create ("reader", PRI_DEFAULT, reader_thread, NULL);
+  for (i = 0; i < READER_CNT; i++)
+    sema_down (&done);
+  return section_cnt;
+}
+
+static void
+reader_thread (void *aux UNUSED) 
+{
+  while (timer_elapsed (start_time) < TIMER_FREQ)
+    {
+      if (use_rwlock)
+        rwlock_read_acquire (&rwlock);
+      else
+        lock_acquire (&lock);
+
+      timer_sleep (1);
+      section_cnt++;
+
+      if (use_rwlock)
+        rwlock_read_release (&rwlock);
+      else
+        lock_release (&lock);
+    }
+  sema_up (&done);
+}
@@ -0,0 +1,12 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+use tests::threads::bench;
+check_benchmark (qr/^\(rwlock-bench\) struct (rw)?lock: \d+ reads per second\.$/,
+		 2, <<'EOF');
+(rwlock-bench) begin
+(rwlock-bench) Running 8 readers with struct lock...
+(rwlock-bench) Running 8 readers with struct rwlock...
+(rwlock-bench) end
+EOF
@@ -0,0 +1,83 @@
+/* The main thread holds a readers-writer lock for writing.  A
+   higher-priority writer and then an even higher-priority reader
+   block on it, and each donates its priority to the main thread.
+   When the main thread lets go, the writer goes first because it
+   was queued before the reader, then the reader, and the main
+   thread's priority drops back.
+
+   Then the main thread holds the lock for reading.  A
+   higher-priority writer blocks waiting for the reader to leave
+   and donates its priority to it, so a medium-priority thread
+   created meanwhile cannot preempt the main thread.  Once the
+   main thread lets go, the writer goes first, then the medium
+   thread. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+
+static struct rwlock rwlock;
+
+static thread_func reader_thread;
+static thread_func writer_thread;
+static thread_func medium_thread;
+
+void
+test_rwlock_donate (void) 
+{
+  /* This test does not work with the MLFQS. */
+  ASSERT (!thread_mlfqs);
+
+  /* Make sure our priority is the default. */
+  ASSERT (thread_get_priority () == PRI_DEFAULT);
+
+  rwlock_init (&rwlock);
+  rwlock_write_acquire (&rwlock);
+
+  thread_create ("writer", PRI_DEFAULT + 5, writer_thread, NULL);
+  msg ("This thread should have priority %d.  Actual priority: %d.",
+       PRI_DEFAULT + 5, thread_get_priority ());
+  thread_create ("reader", PRI_DEFAULT + 10, reader_thread, NULL);
+  msg ("This thread should have priority %d.  Actual priority: %d.",
+       PRI_DEFAULT + 10, thread_get_priority ());
+
+  msg ("Main thread releasing the lock.");
+  rwlock_write_release (&rwlock);
+  msg ("This thread should have priority %d.  Actual priority: %d.",
+       PRI_DEFAULT, thread_get_priority ());
+
+  rwlock_read_acquire (&rwlock);
+  thread_create ("writer", PRI_DEFAULT + 10, writer_thread, NULL);
+  msg ("This thread should have priority %d.  Actual priority: %d.",
+       PRI_DEFAULT + 10, thread_get_priority ());
+  thread_create ("medium", PRI_DEFAULT + 5, medium_thread, NULL);
+
+  msg ("Main thread releasing the read lock.");
+  rwlock_read_release (&rwlock);
+  msg ("This thread should have priority %d.  Actual priority: %d.",
+       PRI_DEFAULT, thread_get_priority ());
+}
+
+static void
+reader_thread (void *aux UNUSED) 
+{
+  rwlock_read_acquire (&rwlock);
+  msg ("Reader acquired the lock.");
+  rwlock_read_release (&rwlock);
+}
+
+static void
+writer_thread (void *aux UNUSED) 
+{
+  rwlock_write_acquire (&rwlock);
+  msg ("Writer acquired the lock.");
+  rwlock_write_release (&rwlock);
+}
+
+static void
+medium_thread (void *aux UNUSED) 
+{
+  msg ("Medium thread ran.");
+}
@@ -0,0 +1,59 @@
+/* Tests that a writer that lets go of a readers-writer lock
+   hands it to the next queued writer.  The main thread holds the
+   lock for writing while two writers and two readers queue up
+   for it, in order of increasing priority, so that each reader
+   outranks the writer queued before it.  Both writers must get
+   the lock before either reader, highest priority first. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+
+static struct rwlock rwlock;
+
+static thread_func reader_thread;
+static thread_func writer_thread;
+
+void
+test_rwlock_handoff (void) 
+{
+  /* This test does not work with the MLFQS. */
+  ASSERT (!thread_mlfqs);
+
+  /* Make sure our priority is the default. */
+  ASSERT (thread_get_priority () == PRI_DEFAULT);
+
+  rwlock_init (&rwlock);
+  rwlock_write_acquire (&rwlock);
+  msg ("Main thread holds the lock for writing.");
+
+  /* Each thread outranks the priority donated to the main thread
+     by the threads before it, so it runs and queues at once. */
+  thread_create ("writer A", PRI_DEFAULT + 1, writer_thread, "A");
+  thread_create ("reader 1", PRI_DEFAULT + 2, reader_thread, "1");
+  thread_create ("writer B", PRI_DEFAULT + 3, writer_thread, "B");
+  thread_create ("reader 2", PRI_DEFAULT + 4, reader_thread, "2");
+  msg ("Two writers and two readers are waiting.");
+
+  msg ("Main thread releasing the lock.");
+  rwlock_write_release (&rwlock);
+  msg ("Main thread finished.");
+}
+
+static void
+reader_thread (void *name) 
+{
+  rwlock_read_acquire (&rwlock);
+  msg ("Reader %s acquired the lock.", (const char *) name);
+  rwlock_read_release (&rwlock);
+}
+
+static void
+writer_thread (void *name) 
+{
+  rwlock_write_acquire (&rwlock);
+  msg ("Writer %s acquired the lock.", (const char *) name);
+  rwlock_write_release (&rwlock);
+}
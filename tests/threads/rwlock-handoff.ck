@@ -0,0 +1,17 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(rwlock-handoff) begin
+(rwlock-handoff) Main thread holds the lock for writing.
+(rwlock-handoff) Two writers and two readers are waiting.
+(rwlock-handoff) Main thread releasing the lock.
+(rwlock-handoff) Writer B acquired the lock.
+(rwlock-handoff) Writer A acquired the lock.
+(rwlock-handoff) Reader 2 acquired the lock.
+(rwlock-handoff) Reader 1 acquired the lock.
+(rwlock-handoff) Main thread finished.
+(rwlock-handoff) end
+EOF
+pass;
@@ -0,0 +1,55 @@
+/* Tests that readers share a readers-writer lock, and that a
+   writer gets it once the last reader has let go. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+
+static struct rwlock rwlock;
+static struct semaphore release;
+
+static thread_func reader_thread;
+static thread_func writer_thread;
+
+void
+test_rwlock_read (void) 
+{
+  /* This test does not work with the MLFQS. */
+  ASSERT (!thread_mlfqs);
+
+  rwlock_init (&rwlock);
+  sema_init (&release, 0);
+
+  rwlock_read_acquire (&rwlock);
+  thread_create ("reader 1", PRI_DEFAULT + 1, reader_thread, NULL);
+  thread_create ("reader 2", PRI_DEFAULT + 1, reader_thread, NULL);
+  msg ("Main thread and both readers hold the lock.");
+
+  thread_create ("writer", PRI_DEFAULT + 2, writer_thread, NULL);
+  msg ("Main thread releasing the lock.");
+  rwlock_read_release (&rwlock);
+
+  sema_up (&release);
+  sema_up (&release);
+  msg ("Main thread finished.");
+}
+
+static void
+reader_thread (void *aux UNUSED) 
+{
+  rwlock_read_acquire (&rwlock);
+  msg ("Thread %s acquired the lock for reading.", thread_name ());
+  sema_down (&release);
+  msg ("Thread %s releasing the lock.", thread_name ());
+  rwlock_read_release (&rwlock);
+}
+
+static void
+writer_thread (void *aux UNUSED) 
+{
+  rwlock_write_acquire (&rwlock);
+  msg ("Writer acquired the lock.");
+  rwlock_write_release (&rwlock);
+}
@@ -0,0 +1,17 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(rwlock-read) begin
+(rwlock-read) Thread reader 1 acquired the lock for reading.
+(rwlock-read) Thread reader 2 acquired the lock for reading.
+(rwlock-read) Main thread and both readers hold the lock.
+(rwlock-read) Main thread releasing the lock.
+(rwlock-read) Thread reader 1 releasing the lock.
+(rwlock-read) Thread reader 2 releasing the lock.
+(rwlock-read) Writer acquired the lock.
+(rwlock-read) Main thread finished.
+(rwlock-read) end
+EOF
+pass;
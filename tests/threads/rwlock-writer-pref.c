@@ -0,0 +1,52 @@
+/* Tests that a waiting writer holds off new readers.  The main
+   thread holds a readers-writer lock for reading while a writer
+   and then a higher-priority reader ask for it.  The reader must
+   not get in until the writer is done. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+
+static struct rwlock rwlock;
+
+static thread_func reader_thread;
+static thread_func writer_thread;
+
+void
+test_rwlock_writer_pref (void) 
+{
+  /* This test does not work with the MLFQS. */
+  ASSERT (!thread_mlfqs);
+
+  rwlock_init (&rwlock);
+
+  rwlock_read_acquire (&rwlock);
+  msg ("Main thread holds the lock for reading.");
+  thread_create ("writer", PRI_DEFAULT + 1, writer_thread, NULL);
+  msg ("Writer is waiting.");
+  thread_create ("reader", PRI_DEFAULT + 2, reader_thread, NULL);
+  msg ("Reader is waiting.");
+
+  msg ("Main thread releasing the lock.");
+  rwlock_read_release (&rwlock);
+  msg ("Main thread finished.");
+}
+
+static void
+reader_thread (void *aux UNUSED) 
+{
+  rwlock_read_acquire (&rwlock);
+  msg ("Reader acquired the lock.");
+  rwlock_read_release (&rwlock);
+}
+
+static void
+writer_thread (void *aux UNUSED) 
+{
+  rwlock_write_acquire (&rwlock);
+  msg ("Writer acquired the lock.");
+  msg ("Writer releasing the lock.");
+  rwlock_write_release (&rwlock);
+}
@@ -0,0 +1,17 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(rwlock-writer-pref) begin
+(rwlock-writer-pref) Main thread holds the lock for reading.
+(rwlock-writer-pref) Writer is waiting.
+(rwlock-writer-pref) Reader is waiting.
+(rwlock-writer-pref) Main thread releasing the lock.
+(rwlock-writer-pref) Writer acquired the lock.
+(rwlock-writer-pref) Writer releasing the lock.
+(rwlock-writer-pref) Reader acquired the lock.
+(rwlock-writer-pref) Main thread finished.
+(rwlock-writer-pref) end
+EOF
+pass;
@@ -0,0 +1,46 @@
+/* Tests sequence locks: a read that no write overlaps succeeds,
+   a read that a write overlaps must be retried, and timer_ticks(),
+   which reads the tick count under a seqlock written by the timer
+   interrupt, never goes backward. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/interrupt.h"
+#include "threads/synch.h"
+#include "devices/timer.h"
+
+void
+test_seqlock (void) 
+{
+  struct seqlock sl;
+  enum intr_level old_level;
+  unsigned seq;
+  int64_t start, last;
+
+  seqlock_init (&sl);
+
+  seq = seqlock_read_begin (&sl);
+  if (seqlock_read_retry (&sl, seq))
+    fail ("read with no writer must not be retried");
+  msg ("Read with no writer succeeded.");
+
+  seq = seqlock_read_begin (&sl);
+  old_level = intr_disable ();
+  seqlock_write_begin (&sl);
+  seqlock_write_end (&sl);
+  intr_set_level (old_level);
+  if (!seqlock_read_retry (&sl, seq))
+    fail ("read overlapped by a write must be retried");
+  msg ("Read overlapped by a write was retried.");
+
+  start = last = timer_ticks ();
+  while (last - start < TIMER_FREQ / 10) 
+    {
+      int64_t now = timer_ticks ();
+      if (now < last)
+        fail ("timer_ticks() went from %lld to %lld", last, now);
+      last = now;
+    }
+  msg ("Tick count never went backward.");
+}
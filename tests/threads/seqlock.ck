@@ -0,0 +1,12 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(seqlock) begin
+(seqlock) Read with no writer succeeded.
+(seqlock) Read overlapped by a write was retried.
+(seqlock) Tick count never went backward.
+(seqlock) end
+EOF
+pass;
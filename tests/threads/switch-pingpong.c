@@ -0,0 +1,71 @@
+/* Measures context switch speed.  The main thread and a "pong"
+   thread hand control back and forth through a pair of
+   semaphores for two seconds, so that every iteration costs two
+   thread switches, and the main thread then reports the number
+   of switches per second.
+
+   The pong thread must run exactly once between two iterations
+   of the main thread, which checks that each switch resumes the
+   other thread where it left off.  Compare the rate against a
+   kernel built from a different tree to see the effect of a
+   change to the switch path. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "devices/timer.h"
+
+#define SECONDS 2
+
+static struct semaphore ping, pong;
+static bool done;
+static long long pong_cnt;
+
+static thread_func pong_thread;
+
+void
+test_switch_pingpong (void) 
+{
+  long long round_cnt = 0;
+  int64_t start_time;
+
+  sema_init (&ping, 0);
+  sema_init (&pong, 0);
+  done = false;
+  pong_cnt = 0;
+
+  thread_create ("pong", thread_get_priority (), pong_thread, NULL);
+
+  msg ("Switching between two threads for %d seconds...", SECONDS);
+  start_time = timer_ticks ();
+  while (timer_elapsed (start_time) < SECONDS * TIMER_FREQ)
+    {
+      sema_up (&ping);
+      sema_down (&pong);
+      round_cnt++;
+      if (pong_cnt != round_cnt)
+        fail ("pong thread ran %lld times in %lld rounds",
+              pong_cnt, round_cnt);
+    }
+  done = true;
+  sema_up (&ping);
+  sema_down (&pong);
+
+  msg ("%lld switches per second.", round_cnt * 2 / SECONDS);
+}
+
+static void
+pong_thread (void *aux UNUSED) 
+{
+  for (;;)
+    {
+      sema_down (&ping);
+      if (done)
+        break;
+      pong_cnt++;
+      sema_up (&pong);
+    }
+  sema_up (&pong);
+}
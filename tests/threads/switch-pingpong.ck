@@ -0,0 +1,11 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+use tests::threads::bench;
+check_benchmark (qr/^\(switch-pingpong\) \d+ switches per second\.$/, 1,
+		 <<'EOF');
+(switch-pingpong) begin
+(switch-pingpong) Switching between two threads for 2 seconds...
+(switch-pingpong) end
+EOF
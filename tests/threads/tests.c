@@ -29,6 +29,15 @@ static const struct test tests[] =
         {"priority-preempt", test_priority_preempt},
         {"priority-sema", test_priority_sema},
         {"priority-condvar", test_priority_condvar},
+        {"switch-pingpong", test_switch_pingpong},
+        {"thread-churn", test_thread_churn},
+        {"condvar-broadcast", test_condvar_broadcast},
+        {"rwlock-read", test_rwlock_read},
+        {"rwlock-writer-pref", test_rwlock_writer_pref},
+        {"rwlock-donate", test_rwlock_donate},
+        {"rwlock-handoff", test_rwlock_handoff},
+        {"seqlock", test_seqlock},
+        {"rwlock-bench", test_rwlock_bench},
         {"mlfqs-load-1", test_mlfqs_load_1},
         {"mlfqs-load-60", test_mlfqs_load_60},
         {"mlfqs-load-avg", test_mlfqs_load_avg},
@@ -38,6 +47,7 @@ static const struct test tests[] =
         {"mlfqs-nice-2", test_mlfqs_nice_2},
         {"mlfqs-nice-10", test_mlfqs_nice_10},
         {"mlfqs-block", test_mlfqs_block},
+        {"mlfqs-stress", test_mlfqs_stress},
 };
 
 static const char *test_name;
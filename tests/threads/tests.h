@@ -23,6 +23,15 @@ extern test_func test_priority_fifo;
 extern test_func test_priority_preempt;
 extern test_func test_priority_sema;
 extern test_func test_priority_condvar;
+extern test_func test_switch_pingpong;
+extern test_func test_thread_churn;
+extern test_func test_condvar_broadcast;
+extern test_func test_rwlock_read;
+extern test_func test_rwlock_writer_pref;
+extern test_func test_rwlock_donate;
+extern test_func test_rwlock_handoff;
+extern test_func test_seqlock;
+extern test_func test_rwlock_bench;
 extern test_func test_mlfqs_load_1;
 extern test_func test_mlfqs_load_60;
 extern test_func test_mlfqs_load_avg;
@@ -32,6 +41,7 @@ extern test_func test_mlfqs_fair_20;
 extern test_func test_mlfqs_nice_2;
 extern test_func test_mlfqs_nice_10;
 extern test_func test_mlfqs_block;
+extern test_func test_mlfqs_stress;
 
 void msg (const char *, ...);
 void fail (const char *, ...);
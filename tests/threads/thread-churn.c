@@ -0,0 +1,66 @@
+/* Measures how fast threads can be created and destroyed.  The
+   main thread repeatedly creates a higher-priority thread, which
+   runs and exits at once, and after two seconds reports the
+   average creation-to-exit latency.  Every new thread after the
+   first can reuse the page of the thread that died before it.
+
+   A reused page is not zeroed, so each thread raises its own
+   priority before exiting and checks that it started with the
+   priority it was created with. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/thread.h"
+#include "devices/timer.h"
+#ifdef USERPROG
+#include "userprog/process.h"
+#endif
+
+#define SECONDS 2
+
+static int exit_cnt;
+
+static thread_func churn_thread;
+
+void
+test_thread_churn (void) 
+{
+  int create_cnt = 0;
+  int64_t start_time;
+
+  /* This test does not work with the MLFQS. */
+  ASSERT (!thread_mlfqs);
+
+  msg ("Creating and exiting threads for %d seconds...", SECONDS);
+  start_time = timer_ticks ();
+  while (timer_elapsed (start_time) < SECONDS * TIMER_FREQ)
+    {
+      tid_t tid = thread_create ("churn", PRI_DEFAULT + 1, churn_thread,
+                                 NULL);
+      if (tid == TID_ERROR)
+        fail ("thread_create() failed after %d threads", create_cnt);
+      create_cnt++;
+      if (exit_cnt != create_cnt)
+        fail ("thread %d did not run before thread_create() returned",
+              create_cnt);
+#ifdef USERPROG
+      /* With USERPROG, a kernel thread also exits through
+         process_exit(), which waits to be reaped by its parent. */
+      process_wait (tid);
+#endif
+    }
+
+  msg ("%lld ns per thread.",
+       (long long) SECONDS * 1000000000 / create_cnt);
+}
+
+static void
+churn_thread (void *aux UNUSED) 
+{
+  if (thread_get_priority () != PRI_DEFAULT + 1)
+    fail ("thread %d started with priority %d", exit_cnt + 1,
+          thread_get_priority ());
+  thread_set_priority (PRI_MAX);
+  exit_cnt++;
+}
@@ -0,0 +1,10 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+use tests::threads::bench;
+check_benchmark (qr/^\(thread-churn\) \d+ ns per thread\.$/, 1, <<'EOF');
+(thread-churn) begin
+(thread-churn) Creating and exiting threads for 2 seconds...
+(thread-churn) end
+EOF
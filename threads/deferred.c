@@ -0,0 +1,144 @@
+#include "threads/deferred.h"
+#include <debug.h>
+#include "threads/interrupt.h"
+#include "threads/thread.h"
+
+/* Deferred work ("bottom halves").
+
+   External interrupt handlers run with interrupts off, so every
+   cycle they spend delays every other interrupt.  Work that does
+   not have to happen before the handler returns can instead be
+   queued with deferred_schedule().  A kernel worker thread at
+   PRI_MAX drains the queues with interrupts on; because it has
+   the highest priority, a handler that queues work yields to it
+   as soon as the interrupt returns. */
+
+/* Pending work, one FIFO per priority. */
+static struct list queues[DEFERRED_PRI_CNT];
+
+/* Worker thread, and whether it is blocked waiting for work. */
+static struct thread *worker;
+static bool worker_idle;
+
+static thread_func worker_loop;
+static struct deferred_work *pop_work(void);
+
+/* Initializes the work queues.  Work may be queued from then
+   on, but it does not run until deferred_start(). */
+void deferred_init(void)
+{
+	int i;
+
+	for (i = 0; i < DEFERRED_PRI_CNT; i++)
+		list_init(&queues[i]);
+}
+
+/* Starts the worker thread.  Must be called after
+   thread_start(). */
+void deferred_start(void)
+{
+	if (thread_create("kworker", PRI_MAX, worker_loop, NULL) == TID_ERROR)
+		PANIC("couldn't create the deferred work thread");
+}
+
+/* Initializes WORK to call FUNC with AUX when it runs. */
+void deferred_work_init(struct deferred_work *work, deferred_func *func, void *aux)
+{
+	ASSERT(work != NULL);
+	ASSERT(func != NULL);
+
+	work->func = func;
+	work->aux = aux;
+	work->pending = false;
+}
+
+/* Queues WORK to run on the worker thread at priority PRI.
+   Returns false, without queuing it again, if WORK is already
+   pending.  May be called from an interrupt handler. */
+bool deferred_schedule(struct deferred_work *work, enum deferred_pri pri)
+{
+	enum intr_level old_level;
+	bool wake = false;
+
+	ASSERT(work != NULL);
+	ASSERT(pri < DEFERRED_PRI_CNT);
+
+	old_level = intr_disable();
+	if (work->pending)
+	{
+		intr_set_level(old_level);
+		return false;
+	}
+	work->pending = true;
+	list_push_back(&queues[pri], &work->elem);
+	if (worker_idle)
+	{
+		worker_idle = false;
+		thread_unblock(worker);
+		wake = true;
+	}
+	intr_set_level(old_level);
+
+	if (wake)
+	{
+		if (intr_context())
+			intr_yield_on_return();
+		else
+			test_max_priority();
+	}
+	return true;
+}
+
+/* Returns true if T is the deferred work thread. */
+bool deferred_is_worker(const struct thread *t)
+{
+	return t != NULL && t == worker;
+}
+
+/* Returns true if the worker thread is in the run queue.
+   Interrupts must be off. */
+bool deferred_is_worker_ready(void)
+{
+	ASSERT(intr_get_level() == INTR_OFF);
+
+	return worker != NULL && worker->status == THREAD_READY;
+}
+
+/* Removes and returns the most urgent pending work item, or a
+   null pointer if there is none.  Interrupts must be off. */
+static struct deferred_work *
+pop_work(void)
+{
+	int i;
+
+	ASSERT(intr_get_level() == INTR_OFF);
+
+	for (i = 0; i < DEFERRED_PRI_CNT; i++)
+		if (!list_empty(&queues[i]))
+			return list_entry(list_pop_front(&queues[i]), struct deferred_work, elem);
+	return NULL;
+}
+
+/* Worker thread: runs queued work items, in priority order,
+   with interrupts enabled, and sleeps when there are none. */
+static void
+worker_loop(void *aux UNUSED)
+{
+	worker = thread_current();
+
+	for (;;)
+	{
+		struct deferred_work *work;
+
+		intr_disable();
+		while ((work = pop_work()) == NULL)
+		{
+			worker_idle = true;
+			thread_block();
+		}
+		work->pending = false;
+		intr_enable();
+
+		work->func(work->aux);
+	}
+}
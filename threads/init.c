@@ -13,6 +13,7 @@
 #include "devices/serial.h"
 #include "devices/timer.h"
 #include "devices/vga.h"
+#include "threads/deferred.h"
 #include "threads/interrupt.h"
 #include "threads/io.h"
 #include "threads/loader.h"
@@ -34,8 +35,12 @@
 #endif
 #ifdef FILESYS
 #include "devices/disk.h"
+#include "filesys/fat.h"
 #include "filesys/filesys.h"
 #include "filesys/fsutil.h"
+#include "filesys/inode.h"
+#include "filesys/page_cache.h"
+#include "filesys/dcache.h"
 #endif
 
 /* Page-map-level-4 with kernel mappings only. */
@@ -93,6 +98,7 @@ main (void) {
 #endif
 
 	/* Initialize interrupt handlers. */
+	deferred_init ();
 	intr_init ();
 	timer_init ();
 	kbd_init ();
@@ -103,6 +109,7 @@ main (void) {
 #endif
 	/* Start thread scheduler and enable interrupts. */
 	thread_start ();
+	deferred_start ();
 	serial_init_queue ();
 	timer_calibrate ();
 
@@ -216,11 +223,21 @@ parse_options (char **argv) {
 #ifdef FILESYS
 		else if (!strcmp (name, "-f"))
 			format_filesys = true;
+		else if (!strcmp (name, "-cs"))
+			fat_format_sectors_per_cluster = atoi (value);
+		else if (!strcmp (name, "-wb-age"))
+			page_cache_dirty_age = atoi (value);
+		else if (!strcmp (name, "-wb-ratio"))
+			page_cache_dirty_ratio = atoi (value);
+		else if (!strcmp (name, "-ic"))
+			inode_cache_limit = atoi (value);
 #endif
 		else if (!strcmp (name, "-rs"))
 			random_init (atoi (value));
 		else if (!strcmp (name, "-mlfqs"))
 			thread_mlfqs = true;
+		else if (!strcmp (name, "-tickless"))
+			timer_tickless = true;
 #ifdef USERPROG
 		else if (!strcmp (name, "-ul"))
 			user_page_limit = atoi (value);
@@ -270,8 +287,10 @@ run_actions (char **argv) {
 		{"ls", 1, fsutil_ls},
 		{"cat", 2, fsutil_cat},
 		{"rm", 2, fsutil_rm},
+		{"extents", 2, fsutil_extents},
 		{"put", 2, fsutil_put},
 		{"get", 2, fsutil_get},
+		{"diskbench", 1, fsutil_diskbench},
 #endif
 		{NULL, 0, NULL},
 	};
@@ -316,6 +335,8 @@ usage (void) {
 			"  ls                 List files in the root directory.\n"
 			"  cat FILE           Print FILE to the console.\n"
 			"  rm FILE            Delete FILE.\n"
+			"  extents FILE       Print the number of extents in FILE.\n"
+			"  diskbench          Print swap or scratch disk throughput.\n"
 			"Use these actions indirectly via `pintos' -g and -p options:\n"
 			"  put FILE           Put FILE into file system from scratch disk.\n"
 			"  get FILE           Get FILE from file system into scratch disk.\n"
@@ -324,8 +345,15 @@ usage (void) {
 			"  -h                 Print this help message and power off.\n"
 			"  -q                 Power off VM after actions or on panic.\n"
 			"  -f                 Format file system disk during startup.\n"
+#ifdef FILESYS
+			"  -cs=SECTORS        Format with SECTORS sectors per cluster.\n"
+			"  -wb-age=MS         Write back data dirty for MS milliseconds.\n"
+			"  -wb-ratio=PCT      Write back all data when PCT%% of cache is dirty.\n"
+			"  -ic=N              Keep up to N closed inodes in memory.\n"
+#endif
 			"  -rs=SEED           Set random number seed to SEED.\n"
 			"  -mlfqs             Use multi-level feedback queue scheduler.\n"
+			"  -tickless          Stop the timer tick while the CPU is idle.\n"
 #ifdef USERPROG
 			"  -ul=COUNT          Limit user memory to COUNT pages.\n"
 #endif
@@ -354,8 +382,12 @@ static void
 print_stats (void) {
 	timer_print_stats ();
 	thread_print_stats ();
+	intr_print_stats ();
 #ifdef FILESYS
 	disk_print_stats ();
+	page_cache_print_stats ();
+	inode_print_stats ();
+	dcache_print_stats ();
 #endif
 	console_print_stats ();
 	kbd_print_stats ();
@@ -103,6 +103,13 @@ static const char *intr_names[INTR_CNT];
 static bool in_external_intr;   /* Are we processing an external interrupt? */
 static bool yield_on_return;    /* Should we yield on interrupt return? */
 
+/* Interrupt latency statistics, in TSC cycles.  off_since is the
+   time at which interrupts were last turned off, by intr_disable()
+   or by the CPU entering an external interrupt handler. */
+static uint64_t off_since;      /* When interrupts went off. */
+static uint64_t max_off;        /* Longest interrupts-off stretch. */
+static uint64_t max_handler[16]; /* Longest run of each IRQ's handler. */
+
 /* Programmable Interrupt Controller helpers. */
 static void pic_init (void);
 static void pic_end_of_interrupt (int irq);
@@ -137,6 +144,12 @@ intr_enable (void) {
 	enum intr_level old_level = intr_get_level ();
 	ASSERT (!intr_context ());
 
+	if (old_level == INTR_OFF) {
+		uint64_t off = rdtsc () - off_since;
+		if (off > max_off)
+			max_off = off;
+	}
+
 	/* Enable interrupts by setting the interrupt flag.
 
 	   See [IA32-v2b] "STI" and [IA32-v3a] 5.8.1 "Masking Maskable
@@ -156,6 +169,9 @@ intr_disable (void) {
 	   Hardware Interrupts". */
 	asm volatile ("cli" : : : "memory"); // 추후 보자
 
+	if (old_level == INTR_ON)
+		off_since = rdtsc ();
+
 	return old_level;
 }
 
@@ -332,6 +348,7 @@ void
 intr_handler (struct intr_frame *frame) {
 	bool external;
 	intr_handler_func *handler;
+	uint64_t start = 0;
 
 	/* External interrupts are special.
 	   We only handle one at a time (so interrupts must be off)
@@ -344,6 +361,9 @@ intr_handler (struct intr_frame *frame) {
 
 		in_external_intr = true;
 		yield_on_return = false;
+
+		/* The CPU turned interrupts off on entry. */
+		start = off_since = rdtsc ();
 	}
 
 	/* Invoke the interrupt's handler. */
@@ -369,11 +389,27 @@ intr_handler (struct intr_frame *frame) {
 		in_external_intr = false;
 		pic_end_of_interrupt (frame->vec_no);
 
+		uint64_t spent = rdtsc () - start;
+		if (spent > max_handler[frame->vec_no - 0x20])
+			max_handler[frame->vec_no - 0x20] = spent;
+
 		if (yield_on_return)
 			thread_yield ();
 	}
 }
 
+/* Prints interrupt latency statistics. */
+void
+intr_print_stats (void) {
+	int irq;
+
+	printf ("Interrupts: longest disabled %"PRIu64" cycles\n", max_off);
+	for (irq = 0; irq < 16; irq++)
+		if (max_handler[irq] != 0)
+			printf ("Interrupts: longest %s handler %"PRIu64" cycles\n",
+					intr_names[0x20 + irq], max_handler[irq]);
+}
+
 /* Dumps interrupt frame F to the console, for debugging. */
 void
 intr_dump_frame (const struct intr_frame *f) {
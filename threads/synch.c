@@ -32,6 +32,85 @@
 #include "threads/interrupt.h"
 #include "threads/thread.h"
 
+static bool wait_queue_less(const struct heap_elem *a_, const struct heap_elem *b_, void *aux UNUSED);
+
+/* Initializes QUEUE as an empty wait queue. */
+void wait_queue_init(struct wait_queue *queue)
+{
+	ASSERT(queue != NULL);
+
+	heap_init(&queue->heap, wait_queue_less, NULL);
+	queue->next_seq = 0;
+}
+
+/* Adds ELEM, standing for thread T, to the back of T's priority
+   level in QUEUE.  Interrupts must be off. */
+void wait_queue_push(struct wait_queue *queue, struct wait_queue_elem *elem, struct thread *t)
+{
+	ASSERT(intr_get_level() == INTR_OFF);
+	ASSERT(elem->queue == NULL);
+
+	elem->thread = t;
+	elem->queue = queue;
+	elem->seq = queue->next_seq++;
+	heap_push(&queue->heap, &elem->elem);
+}
+
+/* Removes and returns the element for the highest-priority,
+   longest-waiting thread in QUEUE, which must not be empty.
+   Interrupts must be off. */
+struct wait_queue_elem *
+wait_queue_pop(struct wait_queue *queue)
+{
+	struct wait_queue_elem *elem;
+
+	ASSERT(intr_get_level() == INTR_OFF);
+
+	elem = heap_entry(heap_pop(&queue->heap), struct wait_queue_elem, elem);
+	elem->queue = NULL;
+	return elem;
+}
+
+/* Returns true if no thread is waiting in QUEUE. */
+bool wait_queue_empty(struct wait_queue *queue)
+{
+	return heap_empty(&queue->heap);
+}
+
+/* Sets the priority of blocked thread T to PRIORITY and moves T
+   within the semaphore and condition wait queues it is in.  T
+   keeps its arrival stamps, so it goes back in front of threads
+   of its new priority that started waiting after it did.
+   Interrupts must be off. */
+void wait_queue_change_priority(struct thread *t, int priority)
+{
+	struct wait_queue_elem *elems[] = {&t->wait_elem, t->cond_elem};
+
+	ASSERT(intr_get_level() == INTR_OFF);
+
+	for (size_t i = 0; i < sizeof elems / sizeof *elems; i++)
+		if (elems[i] != NULL && elems[i]->queue != NULL)
+			heap_remove(&elems[i]->queue->heap, &elems[i]->elem);
+
+	t->priority = priority;
+
+	for (size_t i = 0; i < sizeof elems / sizeof *elems; i++)
+		if (elems[i] != NULL && elems[i]->queue != NULL)
+			heap_push(&elems[i]->queue->heap, &elems[i]->elem);
+}
+
+/* Orders a wait queue by priority, then by arrival. */
+static bool
+wait_queue_less(const struct heap_elem *a_, const struct heap_elem *b_, void *aux UNUSED)
+{
+	const struct wait_queue_elem *a = heap_entry(a_, struct wait_queue_elem, elem);
+	const struct wait_queue_elem *b = heap_entry(b_, struct wait_queue_elem, elem);
+
+	if (a->thread->priority != b->thread->priority)
+		return a->thread->priority > b->thread->priority;
+	return a->seq < b->seq;
+}
+
 /* Initializes semaphore SEMA to VALUE.  A semaphore is a
    nonnegative integer along with two atomic operators for
    manipulating it:
@@ -46,7 +125,7 @@ void sema_init(struct semaphore *sema, unsigned value)
 	ASSERT(sema != NULL); // 세마포어는 널이 아니어야됨
 
 	sema->value = value;
-	list_init(&sema->waiters);
+	wait_queue_init(&sema->waiters);
 }
 
 /* Down or "P" operation on a semaphore.  Waits for SEMA's value
@@ -67,7 +146,7 @@ void sema_down(struct semaphore *sema)
 	old_level = intr_disable();
 	while (sema->value == 0)
 	{
-		list_insert_ordered(&sema->waiters, &thread_current()->elem, cmp_priority, NULL);
+		wait_queue_push(&sema->waiters, &thread_current()->wait_elem, thread_current());
 		thread_block();
 	}
 	sema->value--;
@@ -110,12 +189,8 @@ void sema_up(struct semaphore *sema)
 	ASSERT(sema != NULL);
 
 	old_level = intr_disable();
-	if (!list_empty(&sema->waiters))
-	{
-		list_sort(&sema->waiters, cmp_priority, NULL);
-		thread_unblock(list_entry(list_pop_front(&sema->waiters),
-								  struct thread, elem));
-	}
+	if (!wait_queue_empty(&sema->waiters))
+		thread_unblock(wait_queue_pop(&sema->waiters)->thread);
 	sema->value++;
 	test_max_priority();
 	intr_set_level(old_level);
@@ -269,30 +344,13 @@ bool lock_held_by_current_thread(const struct lock *lock)
 	return lock->holder == thread_current();
 }
 
-/* One semaphore in a list. */
+/* One semaphore in a condition's wait queue. */
 struct semaphore_elem
 {
-	struct list_elem elem;		/* List element. */
-	struct semaphore semaphore; /* This semaphore. */
+	struct wait_queue_elem elem; /* Wait queue element. */
+	struct semaphore semaphore;	 /* This semaphore. */
 };
 
-bool cmp_sem_priority(const struct list_elem *a, const struct list_elem *b, void *aux UNUSED)
-{
-	struct semaphore_elem *sa = list_entry(a, struct semaphore_elem, elem);
-	struct semaphore_elem *sb = list_entry(b, struct semaphore_elem, elem);
-
-	struct list_elem *sa_elem = list_begin(&sa->semaphore.waiters);
-	struct list_elem *sb_elem = list_begin(&sb->semaphore.waiters);
-
-	struct thread *ta = list_entry(sa_elem, struct thread, elem);
-	struct thread *tb = list_entry(sb_elem, struct thread, elem);
-
-	if (ta->priority > tb->priority)
-		return true;
-
-	return false;
-}
-
 /* Initializes condition variable COND.  A condition variable
    allows one piece of code to signal a condition and cooperating
    code to receive the signal and act upon it. */
@@ -300,7 +358,7 @@ void cond_init(struct condition *cond)
 {
 	ASSERT(cond != NULL);
 
-	list_init(&cond->waiters);
+	wait_queue_init(&cond->waiters);
 }
 
 /* Atomically releases LOCK and waits for COND to be signaled by
@@ -326,6 +384,7 @@ void cond_init(struct condition *cond)
 void cond_wait(struct condition *cond, struct lock *lock)
 {
 	struct semaphore_elem waiter;
+	enum intr_level old_level;
 
 	ASSERT(cond != NULL);
 	ASSERT(lock != NULL);
@@ -333,9 +392,20 @@ void cond_wait(struct condition *cond, struct lock *lock)
 	ASSERT(lock_held_by_current_thread(lock));
 
 	sema_init(&waiter.semaphore, 0);
-	list_insert_ordered(&cond->waiters, &waiter.elem, cmp_sem_priority, NULL);
+	waiter.elem.queue = NULL;
+
+	old_level = intr_disable();
+	wait_queue_push(&cond->waiters, &waiter.elem, thread_current());
+	thread_current()->cond_elem = &waiter.elem;
+	intr_set_level(old_level);
+
 	lock_release(lock);
 	sema_down(&waiter.semaphore);
+
+	old_level = intr_disable();
+	thread_current()->cond_elem = NULL;
+	intr_set_level(old_level);
+
 	lock_acquire(lock);
 }
 
@@ -353,11 +423,11 @@ void cond_signal(struct condition *cond, struct lock *lock UNUSED)
 	ASSERT(!intr_context());
 	ASSERT(lock_held_by_current_thread(lock));
 
-	if (!list_empty(&cond->waiters))
-	{
-		list_sort(&cond->waiters, cmp_sem_priority, NULL);
-		sema_up(&list_entry(list_pop_front(&cond->waiters), struct semaphore_elem, elem)->semaphore);
-	}
+	enum intr_level old_level = intr_disable();
+
+	if (!wait_queue_empty(&cond->waiters))
+		sema_up(&wait_queue_entry(wait_queue_pop(&cond->waiters), struct semaphore_elem, elem)->semaphore);
+	intr_set_level(old_level);
 }
 
 /* Wakes up all threads, if any, waiting on COND (protected by
@@ -371,6 +441,296 @@ void cond_broadcast(struct condition *cond, struct lock *lock)
 	ASSERT(cond != NULL);
 	ASSERT(lock != NULL);
 
-	while (!list_empty(&cond->waiters))
+	while (!wait_queue_empty(&cond->waiters))
 		cond_signal(cond, lock);
 }
+
+/* Initializes RW as unlocked. */
+void rwlock_init(struct rwlock *rw)
+{
+	ASSERT(rw != NULL);
+
+	lock_init(&rw->write_lock);
+	lock_init(&rw->mutex);
+	cond_init(&rw->no_readers);
+	cond_init(&rw->writer_in);
+	rw->readers = 0;
+	rw->writers_queued = 0;
+	rw->writer = false;
+	list_init(&rw->reader_list);
+	rw->waiting_writer = NULL;
+}
+
+/* Records in the current thread that it holds RW for reading.
+   RW's mutex must be held. */
+static void
+reader_add(struct rwlock *rw)
+{
+	struct thread *cur = thread_current();
+	enum intr_level old_level;
+	int i;
+
+	for (i = 0; i < RWLOCK_READ_MAX; i++)
+		if (cur->read_holds[i].rw == NULL)
+			break;
+	ASSERT(i < RWLOCK_READ_MAX);
+
+	old_level = intr_disable();
+	cur->read_holds[i].rw = rw;
+	cur->read_holds[i].thread = cur;
+	list_push_back(&rw->reader_list, &cur->read_holds[i].elem);
+	intr_set_level(old_level);
+}
+
+/* Forgets the current thread's hold on RW for reading.  RW's
+   mutex must be held. */
+static void
+reader_remove(struct rwlock *rw)
+{
+	struct thread *cur = thread_current();
+	enum intr_level old_level;
+	int i;
+
+	for (i = 0; i < RWLOCK_READ_MAX; i++)
+		if (cur->read_holds[i].rw == rw)
+			break;
+	ASSERT(i < RWLOCK_READ_MAX);
+
+	old_level = intr_disable();
+	list_remove(&cur->read_holds[i].elem);
+	cur->read_holds[i].rw = NULL;
+	intr_set_level(old_level);
+}
+
+/* Acquires RW for reading, sleeping while a writer holds it or
+   waits for it.  A reader that has to wait queues on the writer's
+   WRITE_LOCK, which donates its priority to the writer and lets
+   waiting readers in by priority once the writer is done.  A
+   reader that gets WRITE_LOCK while other writers are queued
+   passes it on and waits until one of them has taken it.
+
+   This function may sleep, so it must not be called within an
+   interrupt handler. */
+void rwlock_read_acquire(struct rwlock *rw)
+{
+	ASSERT(rw != NULL);
+	ASSERT(!intr_context());
+	ASSERT(!rwlock_write_held_by_current_thread(rw));
+
+	for (;;)
+	{
+		lock_acquire(&rw->mutex);
+		if (!rw->writer && rw->writers_queued == 0)
+		{
+			rw->readers++;
+			reader_add(rw);
+			lock_release(&rw->mutex);
+			return;
+		}
+		lock_release(&rw->mutex);
+
+		/* Wait for the writer to finish. */
+		lock_acquire(&rw->write_lock);
+		lock_acquire(&rw->mutex);
+		lock_release(&rw->write_lock);
+		while (!rw->writer && rw->writers_queued > 0)
+			cond_wait(&rw->writer_in, &rw->mutex);
+		lock_release(&rw->mutex);
+	}
+}
+
+/* Releases RW, which the current thread must hold for reading. */
+void rwlock_read_release(struct rwlock *rw)
+{
+	ASSERT(rw != NULL);
+
+	lock_acquire(&rw->mutex);
+	ASSERT(rw->readers > 0);
+	reader_remove(rw);
+	if (!thread_mlfqs)
+		refresh_priority();
+	if (--rw->readers == 0)
+		cond_signal(&rw->no_readers, &rw->mutex);
+	lock_release(&rw->mutex);
+}
+
+/* Acquires RW for writing, sleeping until other writers and all
+   readers are done.  New readers are held off from the moment
+   this writer asks for the lock, and the readers already in hold
+   this writer's priority until they leave.
+
+   This function may sleep, so it must not be called within an
+   interrupt handler. */
+void rwlock_write_acquire(struct rwlock *rw)
+{
+	ASSERT(rw != NULL);
+	ASSERT(!intr_context());
+
+	lock_acquire(&rw->mutex);
+	rw->writers_queued++;
+	lock_release(&rw->mutex);
+
+	lock_acquire(&rw->write_lock);
+
+	lock_acquire(&rw->mutex);
+	rw->writers_queued--;
+	rw->writer = true;
+	cond_broadcast(&rw->writer_in, &rw->mutex);
+	if (rw->readers > 0)
+	{
+		struct thread *cur = thread_current();
+		enum intr_level old_level = intr_disable();
+
+		rw->waiting_writer = cur;
+		cur->wait_on_readers = rw;
+		if (!thread_mlfqs)
+			rwlock_donate(rw, cur->priority);
+		intr_set_level(old_level);
+
+		while (rw->readers > 0)
+			cond_wait(&rw->no_readers, &rw->mutex);
+
+		old_level = intr_disable();
+		rw->waiting_writer = NULL;
+		cur->wait_on_readers = NULL;
+		intr_set_level(old_level);
+	}
+	lock_release(&rw->mutex);
+}
+
+/* Releases RW, which the current thread must hold for writing.
+   If other writers are queued, readers stay out until they are
+   done. */
+void rwlock_write_release(struct rwlock *rw)
+{
+	ASSERT(rwlock_write_held_by_current_thread(rw));
+
+	lock_acquire(&rw->mutex);
+	rw->writer = false;
+	lock_release(&rw->mutex);
+
+	lock_release(&rw->write_lock);
+}
+
+/* Returns true if the current thread holds RW for writing, false
+   otherwise. */
+bool rwlock_write_held_by_current_thread(const struct rwlock *rw)
+{
+	ASSERT(rw != NULL);
+
+	return lock_held_by_current_thread(&rw->write_lock);
+}
+
+/* Donates PRIORITY to every thread that holds RW for reading, on
+   behalf of the writer waiting for them.  Interrupts must be
+   off. */
+void rwlock_donate(struct rwlock *rw, int priority)
+{
+	struct list_elem *e;
+
+	ASSERT(intr_get_level() == INTR_OFF);
+
+	for (e = list_begin(&rw->reader_list); e != list_end(&rw->reader_list);
+		 e = list_next(e))
+		donate_priority_to(list_entry(e, struct rwlock_reader, elem)->thread,
+						   priority);
+}
+
+/* Returns the highest priority among the writers waiting for
+   rwlocks that T holds for reading, or PRI_MIN if there are
+   none. */
+int rwlock_donated_priority(const struct thread *t)
+{
+	enum intr_level old_level = intr_disable();
+	int priority = PRI_MIN;
+	int i;
+
+	for (i = 0; i < RWLOCK_READ_MAX; i++)
+	{
+		struct rwlock *rw = t->read_holds[i].rw;
+
+		if (rw != NULL && rw->waiting_writer != NULL && rw->waiting_writer->priority > priority)
+			priority = rw->waiting_writer->priority;
+	}
+	intr_set_level(old_level);
+	return priority;
+}
+
+/* Initializes sequence lock SL. */
+void seqlock_init(struct seqlock *sl)
+{
+	ASSERT(sl != NULL);
+
+	sl->seq = 0;
+}
+
+/* Starts a read of the value protected by SL and returns the
+   sequence number to pass to seqlock_read_retry(). */
+unsigned
+seqlock_read_begin(const struct seqlock *sl)
+{
+	unsigned seq;
+
+	while ((seq = sl->seq) & 1)
+		asm volatile("pause");
+	barrier();
+	return seq;
+}
+
+/* Returns true if the value protected by SL may have changed
+   since the seqlock_read_begin() call that returned START, in
+   which case the read must be repeated. */
+bool seqlock_read_retry(const struct seqlock *sl, unsigned start)
+{
+	barrier();
+	return sl->seq != start;
+}
+
+/* Starts a write to the value protected by SL.  Interrupts must
+   be off until the matching seqlock_write_end(). */
+void seqlock_write_begin(struct seqlock *sl)
+{
+	ASSERT(intr_get_level() == INTR_OFF);
+	ASSERT(!(sl->seq & 1));
+
+	sl->seq++;
+	barrier();
+}
+
+/* Ends a write to the value protected by SL. */
+void seqlock_write_end(struct seqlock *sl)
+{
+	ASSERT(sl->seq & 1);
+
+	barrier();
+	sl->seq++;
+}
+
+/* Initializes spinlock LOCK as released. */
+void spin_init(struct spinlock *lock)
+{
+	ASSERT(lock != NULL);
+
+	lock->locked = 0;
+}
+
+/* Acquires LOCK, spinning until it is released by whichever CPU
+   holds it.  Interrupts must be disabled. */
+void spin_lock(struct spinlock *lock)
+{
+	ASSERT(lock != NULL);
+	ASSERT(intr_get_level() == INTR_OFF);
+
+	while (__atomic_exchange_n(&lock->locked, 1, __ATOMIC_ACQUIRE))
+		while (lock->locked)
+			asm volatile("pause");
+}
+
+/* Releases LOCK, which must be held by the current CPU. */
+void spin_unlock(struct spinlock *lock)
+{
+	ASSERT(lock != NULL);
+	ASSERT(lock->locked);
+
+	__atomic_store_n(&lock->locked, 0, __ATOMIC_RELEASE);
+}
@@ -4,12 +4,15 @@
 #include <random.h>
 #include <stdio.h>
 #include <string.h>
+#include "threads/deferred.h"
 #include "threads/flags.h"
 #include "threads/interrupt.h"
 #include "threads/intr-stubs.h"
 #include "threads/palloc.h"
+#include "threads/switch.h"
 #include "threads/synch.h"
 #include "threads/vaddr.h"
+#include "devices/timer.h"
 #include "intrinsic.h"
 #include "fixed_point.h"
 
@@ -32,12 +35,46 @@
 #define RECENT_CPU_DEFAULT 0
 #define LOAD_AVG_DEFAULT 0
 
-/* List of processes in THREAD_READY state, that is, processes
-   that are ready to run but not actually running. */
-static struct list ready_list, sleep_list, all_list;
+/* Per-CPU scheduler state.
 
-/* Idle thread. */
-static struct thread *idle_thread;
+   Each CPU has its own run queue of processes in THREAD_READY
+   state, that is, processes that are ready to run but not
+   actually running.  There is one FIFO list per priority level,
+   and bit N of ready_bitmap is set iff ready_queues[N] is
+   non-empty, so the highest ready priority is found with a
+   single bit scan.  PRI_MAX must therefore stay below 64.
+
+   This is per-CPU groundwork only.  The application processors
+   are never started, so the bootstrap processor is the one CPU
+   that schedules threads and this_cpu() always returns it. */
+struct cpu
+{
+	struct spinlock rq_lock;			   /* Protects the run queue. */
+	struct list ready_queues[PRI_MAX + 1]; /* One FIFO per priority. */
+	uint64_t ready_bitmap;				   /* Non-empty levels of ready_queues. */
+	size_t ready_cnt;					   /* # of threads in the run queue. */
+	struct list_elem *refresh_next;		   /* mlfqs_refresh_ready() cursor. */
+
+	struct thread *idle_thread; /* Idle thread. */
+	unsigned thread_ticks;		/* # of timer ticks since last yield. */
+
+	/* Statistics. */
+	long long idle_ticks;	/* # of timer ticks spent idle. */
+	long long kernel_ticks; /* # of timer ticks in kernel threads. */
+	long long user_ticks;	/* # of timer ticks in user programs. */
+};
+
+#define CPU_MAX 1 /* # of CPUs that run threads. */
+static struct cpu cpus[CPU_MAX];
+
+/* Returns the CPU we are running on. */
+#define this_cpu() (&cpus[0])
+
+static struct list all_list;
+
+/* Processes sleeping in thread_sleep(), ordered by wakeup_tick so
+   that the earliest one is always at the top. */
+static struct heap sleep_queue;
 
 /* Initial thread, the thread running init.c:main(). */
 static struct thread *initial_thread;
@@ -48,25 +85,49 @@ static struct lock tid_lock; //
 /* Thread destruction requests */
 static struct list destruction_req;
 
-/* Statistics. */
-static long long idle_ticks;   /* # of timer ticks spent idle. */
-static long long kernel_ticks; /* # of timer ticks in kernel threads. */
-static long long user_ticks;   /* # of timer ticks in user programs. */
+/* Pages of destroyed threads, kept for reuse by thread_create()
+   so that creating a thread neither goes through the page
+   allocator nor zeroes a whole page; init_thread() clears only
+   the struct thread at the bottom.  Once more than
+   THREAD_CACHE_HIGH pages are cached, the cache is trimmed back
+   to THREAD_CACHE_LOW. */
+#define THREAD_CACHE_HIGH 64
+#define THREAD_CACHE_LOW 16
+static struct list thread_cache;
+static size_t thread_cache_cnt;
+
+/* Thread cache statistics. */
+static long long thread_cache_hits;	  /* # of pages reused. */
+static long long thread_cache_misses; /* # of pages from palloc. */
+static long long thread_cache_trims;  /* # of pages given back. */
 
 static long long next_tick_to_awake; /* # of timer ticks in user programs. */
 
 /* Scheduling. */
-#define TIME_SLICE 4		  /* # of timer ticks to give each thread. */
-static unsigned thread_ticks; /* # of timer ticks since last yield. */
+#define TIME_SLICE 4 /* # of timer ticks to give each thread. */
 
 int load_avg;
 
+/* MLFQS recent_cpu decay is applied lazily.  decay_epoch counts
+   the once-per-second decays so far, and decay_coef[] remembers
+   the coefficient (2*load_avg)/(2*load_avg+1) of the last
+   DECAY_HISTORY of them.  A thread records the epoch its
+   recent_cpu is current for, and mlfqs_recent_cpu() replays the
+   decays it missed only when the thread is about to be looked at
+   again: when it runs, wakes up, or sits in the run queue. */
+#define DECAY_HISTORY 256
+static int decay_coef[DECAY_HISTORY];
+static int64_t decay_epoch;
+
 /* If false (default), use round-robin scheduler.
    If true, use multi-level feedback queue scheduler.
    Controlled by kernel command-line option "-o mlfqs". */
 bool thread_mlfqs;
 
 static void kernel_thread(thread_func *, void *aux);
+static void switch_entry(void);
+static struct thread *thread_page_alloc(void);
+static void thread_page_free(struct thread *t);
 
 static void idle(void *aux UNUSED);
 static struct thread *next_thread_to_run(void);
@@ -74,12 +135,17 @@ static void init_thread(struct thread *, const char *name, int priority);
 static void do_schedule(int status);
 static void schedule(void);
 static tid_t allocate_tid(void);
+static void ready_push(struct thread *t);
+static void ready_remove(struct thread *t);
+static int ready_max_priority(void);
+static void change_priority(struct thread *t, int priority);
+static bool mlfqs_exempt(const struct thread *t);
+static bool wakeup_less(const struct heap_elem *a, const struct heap_elem *b, void *aux UNUSED);
 void thread_sleep(int64_t ticks);
 void thread_awake(int64_t ticks);
 void update_next_tick_to_awake(int64_t ticks);
 int64_t get_next_tick_to_awake(void);
 void test_max_priority(void);
-bool cmp_priority(const struct list_elem *a, const struct list_elem *b, void *aux UNUSED);
 
 /* Returns true if T appears to point to a valid thread. */
 #define is_thread(t) ((t) != NULL && (t)->magic == THREAD_MAGIC)
@@ -115,11 +181,11 @@ void thread_sleep(int64_t ticks)
 	enum intr_level old_level;
 
 	old_level = intr_disable();
-	if (curr != idle_thread)
+	if (curr != this_cpu()->idle_thread)
 	{
 		curr->wakeup_tick = ticks;
 		update_next_tick_to_awake(ticks);
-		list_push_back(&sleep_list, &curr->elem);
+		heap_push(&sleep_queue, &curr->sleep_elem);
 		do_schedule(THREAD_BLOCKED);
 	}
 
@@ -128,46 +194,107 @@ void thread_sleep(int64_t ticks)
 
 void test_max_priority(void)
 {
-	if (!intr_context() && !list_empty(&ready_list))
+	if (!intr_context() && this_cpu()->ready_bitmap != 0)
 	{
-		struct thread *ready_max_t = list_entry(list_begin(&ready_list), struct thread, elem);
-		if (ready_max_t->priority > thread_current()->priority)
+		if (ready_max_priority() > thread_current()->priority)
 			thread_yield();
 	}
 }
 
-bool cmp_priority(const struct list_elem *a, const struct list_elem *b, void *aux UNUSED)
+/* Appends T to the run queue of its priority level. */
+static void
+ready_push(struct thread *t)
+{
+	struct cpu *c = this_cpu();
+
+	ASSERT(intr_get_level() == INTR_OFF);
+
+	spin_lock(&c->rq_lock);
+	list_push_back(&c->ready_queues[t->priority], &t->elem);
+	c->ready_bitmap |= 1ULL << t->priority;
+	c->ready_cnt++;
+	spin_unlock(&c->rq_lock);
+}
+
+/* Removes T, which must be in the run queue at level
+   T->priority, from the run queue. */
+static void
+ready_remove(struct thread *t)
+{
+	struct cpu *c = this_cpu();
+
+	ASSERT(intr_get_level() == INTR_OFF);
+	ASSERT(t->status == THREAD_READY);
+
+	spin_lock(&c->rq_lock);
+	if (c->refresh_next == &t->elem)
+		c->refresh_next = list_next(&t->elem);
+	list_remove(&t->elem);
+	if (list_empty(&c->ready_queues[t->priority]))
+		c->ready_bitmap &= ~(1ULL << t->priority);
+	c->ready_cnt--;
+	spin_unlock(&c->rq_lock);
+}
+
+/* Returns the highest priority that has a ready thread.
+   The run queue must not be empty. */
+static int
+ready_max_priority(void)
+{
+	uint64_t bitmap = this_cpu()->ready_bitmap;
+
+	ASSERT(bitmap != 0);
+
+	return 63 - __builtin_clzll(bitmap);
+}
+
+/* Sets T's effective priority to PRIORITY, moving T to the
+   matching run queue level if it is ready to run, or within the
+   wait queues it is in if it is blocked. */
+static void
+change_priority(struct thread *t, int priority)
 {
-	struct thread *t_a;
-	struct thread *t_b;
+	enum intr_level old_level = intr_disable();
+
+	if (t->status == THREAD_READY && t->priority != priority)
+	{
+		ready_remove(t);
+		t->priority = priority;
+		ready_push(t);
+	}
+	else if (t->status == THREAD_BLOCKED)
+		wait_queue_change_priority(t, priority);
+	else
+		t->priority = priority;
+
+	intr_set_level(old_level);
+}
 
-	t_a = list_entry(a, struct thread, elem);
-	t_b = list_entry(b, struct thread, elem);
-	if (t_a->priority > t_b->priority)
-		return true;
-	return false;
+/* Orders the sleep queue by wakeup tick. */
+static bool
+wakeup_less(const struct heap_elem *a, const struct heap_elem *b, void *aux UNUSED)
+{
+	return heap_entry(a, struct thread, sleep_elem)->wakeup_tick < heap_entry(b, struct thread, sleep_elem)->wakeup_tick;
 }
 
+/* Wakes up every thread whose wakeup tick is at or before TICKS.
+   Only the expired threads are visited, so this costs
+   O(k log n) for k wakeups out of n sleepers. */
 void thread_awake(int64_t ticks)
 {
 	next_tick_to_awake = INT64_MAX;
-	struct thread *t = NULL;
-	struct list_elem *temp_elem = list_begin(&sleep_list);
 
-	while (temp_elem != list_tail(&sleep_list))
+	while (!heap_empty(&sleep_queue))
 	{
-		t = list_entry(temp_elem, struct thread, elem);
-		if (t->wakeup_tick <= ticks)
-		{
-			// temp_elem = list_remove(&t->elem);
-			temp_elem = list_remove(temp_elem);
-			thread_unblock(t);
-		}
-		else
+		struct thread *t = heap_entry(heap_top(&sleep_queue), struct thread, sleep_elem);
+
+		if (t->wakeup_tick > ticks)
 		{
 			update_next_tick_to_awake(t->wakeup_tick);
-			temp_elem = temp_elem->next;
+			break;
 		}
+		heap_pop(&sleep_queue);
+		thread_unblock(t);
 	}
 }
 
@@ -196,9 +323,17 @@ void thread_init(void)
 
 	/* Init the globla thread context */
 	lock_init(&tid_lock);
-	list_init(&ready_list);
+	for (int i = 0; i < CPU_MAX; i++)
+	{
+		spin_init(&cpus[i].rq_lock);
+		for (int pri = PRI_MIN; pri <= PRI_MAX; pri++)
+			list_init(&cpus[i].ready_queues[pri]);
+		cpus[i].refresh_next = NULL;
+	}
 	list_init(&destruction_req);
-	list_init(&sleep_list);
+	list_init(&thread_cache);
+	heap_init(&sleep_queue, wakeup_less, NULL);
+	next_tick_to_awake = INT64_MAX;
 	list_init(&all_list);
 
 	/* Set up a thread structure for the running thread. */
@@ -230,28 +365,32 @@ void thread_start(void)
    Thus, this function runs in an external interrupt context. */
 void thread_tick(void)
 {
+	struct cpu *c = this_cpu();
 	struct thread *t = thread_current();
 
 	/* Update statistics. */
-	if (t == idle_thread)
-		idle_ticks++;
+	if (t == c->idle_thread)
+		c->idle_ticks++;
 #ifdef USERPROG
 	else if (t->pml4 != NULL)
-		user_ticks++;
+		c->user_ticks++;
 #endif
 	else
-		kernel_ticks++;
+		c->kernel_ticks++;
 
 	/* Enforce preemption. */
-	if (++thread_ticks >= TIME_SLICE)
+	if (++c->thread_ticks >= TIME_SLICE)
 		intr_yield_on_return();
 }
 
 /* Prints thread statistics. */
 void thread_print_stats(void)
 {
-	printf("Thread: %lld idle ticks, %lld kernel ticks, %lld user ticks\n",
-		   idle_ticks, kernel_ticks, user_ticks);
+	for (int i = 0; i < CPU_MAX; i++)
+		printf("Thread: %lld idle ticks, %lld kernel ticks, %lld user ticks\n",
+			   cpus[i].idle_ticks, cpus[i].kernel_ticks, cpus[i].user_ticks);
+	printf("Thread cache: %lld hits, %lld misses, %lld pages trimmed, %zu cached\n",
+		   thread_cache_hits, thread_cache_misses, thread_cache_trims, thread_cache_cnt);
 }
 
 /* Creates a new kernel thread named NAME with the given initial
@@ -278,7 +417,7 @@ tid_t thread_create(const char *name, int priority,
 	ASSERT(function != NULL);
 
 	/* Allocate thread. */
-	t = palloc_get_page(PAL_ZERO);
+	t = thread_page_alloc();
 	if (t == NULL)
 		return TID_ERROR;
 
@@ -300,6 +439,14 @@ tid_t thread_create(const char *name, int priority,
 	t->tf.cs = SEL_KCSEG;
 	t->tf.eflags = FLAG_IF;
 
+	/* The first switch_threads() to T returns into switch_entry(),
+	   which launches it from T->tf.  The frame is placed so that
+	   switch_entry() starts with the stack aligned as if called. */
+	struct switch_threads_frame *sf =
+		(struct switch_threads_frame *)((uint8_t *)t + PGSIZE - sizeof *sf - sizeof(void *));
+	sf->rip = switch_entry;
+	t->switch_rsp = (uint64_t)sf;
+
 	list_push_back(&thread_current()->child_list, &t->child_elem);
 
 	// fdt 관련 initialize
@@ -360,8 +507,14 @@ void thread_unblock(struct thread *t)
 
 	old_level = intr_disable();
 	ASSERT(t->status == THREAD_BLOCKED);
-	list_insert_ordered(&ready_list, &t->elem, cmp_priority, NULL);
+	if (thread_mlfqs)
+	{
+		/* T was not decayed while it was blocked. */
+		mlfqs_recent_cpu(t);
+		mlfqs_priority(t);
+	}
 	t->status = THREAD_READY;
+	ready_push(t);
 	intr_set_level(old_level);
 }
 
@@ -424,8 +577,8 @@ void thread_yield(void)
 	ASSERT(!intr_context()); // 외부 인터럽트에 프로세싱 안 하는 것 맞는지 확인
 
 	old_level = intr_disable(); // intr level을 off로 바꿔줌
-	if (curr != idle_thread)	// 현재 쓰레드가 아이들쓰레드가 아니라면,
-		list_insert_ordered(&ready_list, &curr->elem, cmp_priority, NULL);
+	if (curr != this_cpu()->idle_thread)	// 현재 쓰레드가 아이들쓰레드가 아니라면,
+		ready_push(curr);
 	do_schedule(THREAD_READY); // cpu를 점유하고 있는 현재 스레드를 다른 스레드로 교체해주고 현재 스레드를 ready로 바꿔준다
 	intr_set_level(old_level); // itrl level을 off로 해줌
 }
@@ -454,19 +607,40 @@ int thread_get_priority(void)
 
 void donate_priority(void)
 {
-	struct thread *temp_t = thread_current();
+	struct thread *cur = thread_current();
+
+	if (cur->wait_on_lock != NULL && cur->wait_on_lock->holder != NULL)
+		donate_priority_to(cur->wait_on_lock->holder, cur->priority);
+}
+
+/* Raises T's priority to at least PRIORITY and passes the
+   donation on to whoever T is waiting for: the holder of the lock
+   T waits on or, if T is a writer waiting for readers, the
+   rwlock's readers.  Follows at most NESTED_DEPTH links. */
+void donate_priority_to(struct thread *t, int priority)
+{
+	enum intr_level old_level = intr_disable();
+	int depth;
 
-	int depth = 1;
-	while (depth < NESTED_DEPTH && temp_t->wait_on_lock != NULL)
+	for (depth = 1; depth < NESTED_DEPTH; depth++)
 	{
-		if (temp_t->wait_on_lock->holder > 0x100)
-			temp_t = temp_t->wait_on_lock->holder;
+		bool raised = t->priority < priority;
 
-		if (temp_t->priority < thread_current()->priority)
-			temp_t->priority = thread_current()->priority;
+		if (raised)
+			change_priority(t, priority);
 
-		depth++;
+		if (t->wait_on_lock != NULL && t->wait_on_lock->holder != NULL)
+			t = t->wait_on_lock->holder;
+		else
+		{
+			/* A writer that already had PRIORITY passed it on to
+			   its readers when it got it. */
+			if (raised && t->wait_on_readers != NULL)
+				rwlock_donate(t->wait_on_readers, priority);
+			break;
+		}
 	}
+	intr_set_level(old_level);
 }
 
 void remove_with_lock(struct lock *lock)
@@ -487,8 +661,11 @@ void refresh_priority(void)
 {
 	struct list_elem *temp_elem = list_begin(&thread_current()->donations);
 	struct thread *temp_t = NULL;
+	int donated = rwlock_donated_priority(thread_current());
 
 	thread_current()->priority = thread_current()->init_priority;
+	if (thread_current()->priority < donated)
+		thread_current()->priority = donated;
 
 	while (temp_elem != list_tail(&thread_current()->donations))
 	{
@@ -501,36 +678,71 @@ void refresh_priority(void)
 	}
 }
 
+/* Returns true if T is a housekeeping thread that the MLFQS
+   neither charges nor counts as ready. */
+static bool
+mlfqs_exempt(const struct thread *t)
+{
+	return t == this_cpu()->idle_thread || deferred_is_worker(t);
+}
+
 /* priority = PRI_MAX - (recent_cpu / 4) - (nice * 2) */
 void mlfqs_priority(struct thread *t)
 {
-	if (t == idle_thread)
+	if (mlfqs_exempt(t))
 		return;
 
-	t->priority = fp_to_int(add_mixed(div_mixed(t->recent_cpu, -4), PRI_MAX - t->nice * 2));
+	int priority = fp_to_int(add_mixed(div_mixed(t->recent_cpu, -4), PRI_MAX - t->nice * 2));
+
+	if (priority > PRI_MAX)
+		priority = PRI_MAX;
+	else if (priority < PRI_MIN)
+		priority = PRI_MIN;
+	change_priority(t, priority);
 }
 
-/* recent_cpu = (2 * load_avg) / (2 * load_avg + 1) * recent_cpu + nice */
+/* recent_cpu = (2 * load_avg) / (2 * load_avg + 1) * recent_cpu + nice
+
+   Brings T's recent_cpu up to date by replaying, in order, every
+   decay that happened since T was last brought up to date.  A
+   thread that missed more than DECAY_HISTORY decays first jumps
+   to the fixed point of the oldest remembered coefficient, which
+   is where the skipped decays would have been pulling it. */
 void mlfqs_recent_cpu(struct thread *t)
 {
-	int recent_cpu = t->recent_cpu;
-	int nice = t->nice;
+	int64_t missed = decay_epoch - t->recent_cpu_epoch;
 
-	if (t == idle_thread)
+	if (mlfqs_exempt(t) || missed == 0)
+	{
+		t->recent_cpu_epoch = decay_epoch;
 		return;
+	}
+
+	if (missed > DECAY_HISTORY)
+	{
+		int coef = decay_coef[(decay_epoch - DECAY_HISTORY + 1) % DECAY_HISTORY];
 
-	t->recent_cpu = add_mixed(mul_fp(div_fp(mul_mixed(load_avg, 2), add_mixed(mul_mixed(load_avg, 2), 1)), t->recent_cpu), t->nice);
+		t->recent_cpu = div_fp(int_to_fp(t->nice), sub_fp(F, coef));
+		t->recent_cpu_epoch = decay_epoch - DECAY_HISTORY;
+	}
+	while (t->recent_cpu_epoch < decay_epoch)
+	{
+		int coef = decay_coef[++t->recent_cpu_epoch % DECAY_HISTORY];
+
+		t->recent_cpu = add_mixed(mul_fp(coef, t->recent_cpu), t->nice);
+	}
 }
 
 /* load_avg = (59/60) * load_avg + (1/60) * ready_threads
-   ready_threads : ready_list에 있는 thread와 실행 중인 thread의 총 개수 */
+   ready_threads : run queue에 있는 thread와 실행 중인 thread의 총 개수 */
 void mlfqs_load_avg(void)
 {
-	int ready_threads;
-	if (thread_current() == idle_thread)
-		ready_threads = 0;
-	else
-		ready_threads = list_size(&ready_list) + 1;
+	int ready_threads = this_cpu()->ready_cnt;
+
+	if (!mlfqs_exempt(thread_current()))
+		ready_threads++;
+	if (deferred_is_worker_ready())
+		ready_threads--;
 
 	int load_avg_coef = div_mixed(int_to_fp(59), 60);
 	load_avg = add_fp(mul_fp(load_avg_coef, load_avg), div_mixed(int_to_fp(ready_threads), 60));
@@ -538,35 +750,76 @@ void mlfqs_load_avg(void)
 
 void mlfqs_increment(void)
 {
-	if (thread_current() == idle_thread)
+	if (mlfqs_exempt(thread_current()))
 		return;
 
 	thread_current()->recent_cpu = add_fp(thread_current()->recent_cpu, F);
 }
 
-void mlfqs_recalc_recent_cpu(void)
+/* Starts a new decay epoch with the current load_avg.  Called
+   once per second from the timer interrupt, after load_avg has
+   been updated.  Only the running thread is decayed right away;
+   ready threads are caught up by mlfqs_refresh_ready() and
+   blocked ones when they are unblocked. */
+void mlfqs_decay(void)
 {
-	struct list_elem *temp_elem = list_begin(&all_list);
+	int twice_load = mul_mixed(load_avg, 2);
 
-	while (temp_elem != list_tail(&all_list))
-	{
-		struct thread *temp_t = list_entry(temp_elem, struct thread, all_elem);
-		mlfqs_recent_cpu(temp_t);
+	ASSERT(intr_get_level() == INTR_OFF);
 
-		temp_elem = temp_elem->next;
-	}
+	decay_epoch++;
+	decay_coef[decay_epoch % DECAY_HISTORY] = div_fp(twice_load, add_mixed(twice_load, 1));
+	mlfqs_recent_cpu(thread_current());
+}
+
+/* Recomputes the running thread's priority.  Called every fourth
+   tick from the timer interrupt; no other thread's recent_cpu or
+   nice can have changed since its priority was last computed.
+   Yields on return if a ready thread now outranks it. */
+void mlfqs_update_current(void)
+{
+	struct thread *cur = thread_current();
+	struct cpu *c = this_cpu();
+
+	ASSERT(intr_context());
+
+	mlfqs_priority(cur);
+	if (cur != c->idle_thread && c->ready_bitmap != 0 && ready_max_priority() > cur->priority)
+		intr_yield_on_return();
 }
 
-void mlfqs_recalc_priority(void)
+/* Brings every thread in the run queue up to the current decay
+   epoch and moves it to the queue for its new priority.  Runs
+   once per second from the deferred work thread.  A thread that
+   moves to a lower level not yet visited is seen a second time,
+   which leaves it where it is.
+
+   Interrupts are turned off only around each thread's update.
+   In between, the thread to visit next may leave the run queue,
+   so it is kept in the CPU's refresh_next, which ready_remove()
+   advances past a thread that it removes. */
+void mlfqs_refresh_ready(void)
 {
-	struct list_elem *temp_elem = list_begin(&all_list);
+	struct cpu *c = this_cpu();
+	enum intr_level old_level;
 
-	while (temp_elem != list_tail(&all_list))
+	for (int pri = PRI_MAX; pri >= PRI_MIN; pri--)
 	{
-		struct thread *temp_t = list_entry(temp_elem, struct thread, all_elem);
-		mlfqs_priority(temp_t);
+		old_level = intr_disable();
+		c->refresh_next = list_begin(&c->ready_queues[pri]);
+		while (c->refresh_next != list_end(&c->ready_queues[pri]))
+		{
+			struct thread *t = list_entry(c->refresh_next, struct thread, elem);
 
-		temp_elem = temp_elem->next;
+			c->refresh_next = list_next(c->refresh_next);
+			mlfqs_recent_cpu(t);
+			mlfqs_priority(t);
+
+			intr_set_level(old_level);
+			old_level = intr_disable();
+		}
+		c->refresh_next = NULL;
+		intr_set_level(old_level);
 	}
 }
 
@@ -575,6 +828,7 @@ void thread_set_nice(int nice)
 {
 	enum intr_level old_level = intr_disable();
 
+	mlfqs_recent_cpu(thread_current());
 	thread_current()->nice = nice;
 	mlfqs_priority(thread_current());
 
@@ -612,6 +866,7 @@ int thread_get_recent_cpu(void)
 {
 	enum intr_level old_level = intr_disable();
 
+	mlfqs_recent_cpu(thread_current());
 	int result = fp_to_int_round(mul_mixed(thread_current()->recent_cpu, 100));
 
 	intr_set_level(old_level);
@@ -633,15 +888,20 @@ idle(void *idle_started_ UNUSED)
 {
 	struct semaphore *idle_started = idle_started_;
 
-	idle_thread = thread_current();
+	this_cpu()->idle_thread = thread_current();
 	sema_up(idle_started);
 
 	for (;;)
 	{
 		/* Let someone else run. */
 		intr_disable();
+		timer_idle_exit();
 		thread_block();
 
+		/* Nothing to run: in tickless mode, skip the timer ticks
+		   until the next sleeper is due. */
+		timer_idle_enter();
+
 		/* Re-enable interrupts and wait for the next one.
 
 		   The `sti' instruction disables interrupts until the
@@ -693,9 +953,11 @@ init_thread(struct thread *t, const char *name, int priority)
 
 	list_init(&t->donations);
 	t->wait_on_lock = NULL;
+	t->wait_on_readers = NULL;
 
 	t->nice = NICE_DEFAULT;
 	t->recent_cpu = RECENT_CPU_DEFAULT;
+	t->recent_cpu_epoch = decay_epoch;
 
 	list_push_front(&all_list, &t->all_elem);
 
@@ -724,10 +986,15 @@ init_thread(struct thread *t, const char *name, int priority)
 static struct thread *
 next_thread_to_run(void)
 {
-	if (list_empty(&ready_list))
-		return idle_thread;
-	else
-		return list_entry(list_pop_front(&ready_list), struct thread, elem);
+	struct cpu *c = this_cpu();
+	struct thread *t;
+
+	if (c->ready_bitmap == 0)
+		return c->idle_thread;
+
+	t = list_entry(list_front(&c->ready_queues[ready_max_priority()]), struct thread, elem);
+	ready_remove(t);
+	return t;
 }
 
 /* Use iretq to launch the thread */
@@ -760,75 +1027,74 @@ void do_iret(struct intr_frame *tf)
 		: "memory");
 }
 
-/* Switching the thread by activating the new thread's page
-   tables, and, if the previous thread is dying, destroying it.
-
-   At this function's invocation, we just switched from thread
-   PREV, the new thread is already running, and interrupts are
-   still disabled.
+/* Switches from the running thread to TH, which must have been
+   switched away from by an earlier call to this function or be
+   a new thread from thread_create().
 
-   It's not safe to call printf() until the thread switch is
-   complete.  In practice that means that printf()s should be
-   added at the end of the function. */
+   Only callee-saved registers and the stack pointer are saved,
+   in switch_threads(); the full intr_frame and iretq of do_iret()
+   are used only to launch a new thread for the first time. */
 static void
 thread_launch(struct thread *th)
 {
-	uint64_t tf_cur = (uint64_t)&running_thread()->tf;
-	uint64_t tf = (uint64_t)&th->tf;
 	ASSERT(intr_get_level() == INTR_OFF);
 
-	/* The main switching logic.
-	 * We first restore the whole execution context into the intr_frame
-	 * and then switching to the next thread by calling do_iret.
-	 * Note that, we SHOULD NOT use any stack from here
-	 * until switching is done. */
-	__asm __volatile(
-		/* Store registers that will be used. */
-		"push %%rax\n"
-		"push %%rbx\n"
-		"push %%rcx\n"
-		/* Fetch input once */
-		"movq %0, %%rax\n"
-		"movq %1, %%rcx\n"
-		"movq %%r15, 0(%%rax)\n"
-		"movq %%r14, 8(%%rax)\n"
-		"movq %%r13, 16(%%rax)\n"
-		"movq %%r12, 24(%%rax)\n"
-		"movq %%r11, 32(%%rax)\n"
-		"movq %%r10, 40(%%rax)\n"
-		"movq %%r9, 48(%%rax)\n"
-		"movq %%r8, 56(%%rax)\n"
-		"movq %%rsi, 64(%%rax)\n"
-		"movq %%rdi, 72(%%rax)\n"
-		"movq %%rbp, 80(%%rax)\n"
-		"movq %%rdx, 88(%%rax)\n"
-		"pop %%rbx\n" // Saved rcx
-		"movq %%rbx, 96(%%rax)\n"
-		"pop %%rbx\n" // Saved rbx
-		"movq %%rbx, 104(%%rax)\n"
-		"pop %%rbx\n" // Saved rax
-		"movq %%rbx, 112(%%rax)\n"
-		"addq $120, %%rax\n"
-		"movw %%es, (%%rax)\n"
-		"movw %%ds, 8(%%rax)\n"
-		"addq $32, %%rax\n"
-		"call __next\n" // read the current rip.
-		"__next:\n"
-		"pop %%rbx\n"
-		"addq $(out_iret -  __next), %%rbx\n"
-		"movq %%rbx, 0(%%rax)\n" // rip
-		"movw %%cs, 8(%%rax)\n"	 // cs
-		"pushfq\n"
-		"popq %%rbx\n"
-		"mov %%rbx, 16(%%rax)\n" // eflags
-		"mov %%rsp, 24(%%rax)\n" // rsp
-		"movw %%ss, 32(%%rax)\n"
-		"mov %%rcx, %%rdi\n"
-		"call do_iret\n"
-		"out_iret:\n"
-		:
-		: "g"(tf_cur), "g"(tf)
-		: "memory");
+	switch_threads(&running_thread()->switch_rsp, th->switch_rsp);
+}
+
+/* First code run by a new thread, on its own stack, when the
+   scheduler switches to it for the first time.  Interrupts are
+   still off. */
+static void
+switch_entry(void)
+{
+	do_iret(&running_thread()->tf);
+}
+
+/* Returns a page for a new thread, from the thread cache if
+   possible.  Only the struct thread at the bottom of the page is
+   meant to be initialized; the rest may hold stale stack data.
+   Returns a null pointer if no page is available. */
+static struct thread *
+thread_page_alloc(void)
+{
+	struct thread *t = NULL;
+	enum intr_level old_level = intr_disable();
+
+	if (!list_empty(&thread_cache))
+	{
+		t = list_entry(list_pop_front(&thread_cache), struct thread, elem);
+		thread_cache_cnt--;
+		thread_cache_hits++;
+	}
+	else
+		thread_cache_misses++;
+	intr_set_level(old_level);
+
+	if (t == NULL)
+		t = palloc_get_page(0);
+	return t;
+}
+
+/* Puts the page of destroyed thread T into the thread cache.
+   Recently freed pages are reused first, while they are still
+   warm in the CPU cache.  Interrupts must be off. */
+static void
+thread_page_free(struct thread *t)
+{
+	ASSERT(intr_get_level() == INTR_OFF);
+
+	t->magic = 0;
+	list_push_front(&thread_cache, &t->elem);
+	if (++thread_cache_cnt <= THREAD_CACHE_HIGH)
+		return;
+
+	while (thread_cache_cnt > THREAD_CACHE_LOW)
+	{
+		palloc_free_page(list_entry(list_pop_back(&thread_cache), struct thread, elem));
+		thread_cache_cnt--;
+		thread_cache_trims++;
+	}
 }
 
 /* Schedules a new process. At entry, interrupts must be off.
@@ -845,7 +1111,7 @@ do_schedule(int status)
 		struct thread *victim =
 			list_entry(list_pop_front(&destruction_req), struct thread, elem);
 		list_remove(&victim->all_elem);
-		palloc_free_page(victim);
+		thread_page_free(victim);
 	}
 	thread_current()->status = status;
 	schedule();
@@ -864,7 +1130,7 @@ schedule(void)
 	next->status = THREAD_RUNNING;
 
 	/* Start new time slice. */
-	thread_ticks = 0;
+	this_cpu()->thread_ticks = 0;
 
 #ifdef USERPROG
 	/* Activate the new address space. */
@@ -609,9 +609,7 @@ load(const char *file_name, struct intr_frame *if_)
 	process_activate(thread_current());
 
 	/* Open executable file. */
-	lock_acquire(&file_lock);
 	file = filesys_open(argv[0]);
-	lock_release(&file_lock);
 
 	if (file == NULL)
 	{
@@ -34,8 +34,6 @@ void syscall_handler(struct intr_frame *);
 #define STDIN 1	 // 표준 입력
 #define STDOUT 2 // 표준 출력
 
-// readers-writers를 위한 semaphore와 cnt
-
 void halt(void);
 void exit(int status);
 tid_t fork(const char *thread_name, struct intr_frame *if_);
@@ -62,11 +60,12 @@ int inumber(int fd);
 int symlink(const char *target, const char *linkpath);
 
 int dup2(int oldfd, int newfd);
+int fsync(int fd);
+int fallocate(int fd, off_t offset, off_t len);
+off_t lseek(int fd, off_t offset, int whence);
 
 void syscall_init(void)
 {
-	lock_init(&file_lock);
-
 	write_msr(MSR_STAR, ((uint64_t)SEL_UCSEG - 0x10) << 48 |
 							((uint64_t)SEL_KCSEG) << 32);
 	write_msr(MSR_LSTAR, (uint64_t)syscall_entry);
@@ -305,6 +304,25 @@ void syscall_handler(struct intr_frame *f)
 		// argv[1]: int newfd
 		f->R.rax = dup2(f->R.rdi, f->R.rsi);
 		break;
+
+	case SYS_FSYNC:
+		// argv[0]: int fd
+		f->R.rax = fsync(f->R.rdi);
+		break;
+
+	case SYS_FALLOCATE:
+		// argv[0]: int fd
+		// argv[1]: off_t offset
+		// argv[2]: off_t len
+		f->R.rax = fallocate(f->R.rdi, f->R.rsi, f->R.rdx);
+		break;
+
+	case SYS_LSEEK:
+		// argv[0]: int fd
+		// argv[1]: off_t offset
+		// argv[2]: int whence
+		f->R.rax = lseek(f->R.rdi, f->R.rsi, f->R.rdx);
+		break;
 	}
 }
 
@@ -365,11 +383,7 @@ initial_size를 가진 file 생성
 */
 bool create(const char *file, unsigned initial_size)
 {
-	lock_acquire(&file_lock);
-	bool succ = filesys_create(file, initial_size);
-	lock_release(&file_lock);
-
-	return succ;
+	return filesys_create(file, initial_size);
 }
 
 /* 해당 file 삭제 */
@@ -381,9 +395,7 @@ bool remove(const char *file)
 /* 입력 받은 file을 열어서 file descripter 생성 */
 int open(const char *file)
 {
-	lock_acquire(&file_lock);
 	struct file *f = filesys_open(file);
-	lock_release(&file_lock);
 
 	if (f == NULL)
 		return -1;
@@ -435,11 +447,7 @@ int read(int fd, void *buffer, unsigned size)
 		}
 	}
 	else
-	{
-		lock_acquire(&file_lock);
 		read_result = file_read(f, buffer, size);
-		lock_release(&file_lock);
-	}
 
 	return read_result;
 }
@@ -464,9 +472,7 @@ int write(int fd, const void *buffer, unsigned size)
 		if (inode_is_dir(f->inode) == INODE_DIR)
 			return -1;
 
-		lock_acquire(&file_lock);
 		write_result = file_write(f, buffer, size);
-		lock_release(&file_lock);
 	}
 
 	return write_result;
@@ -563,6 +569,67 @@ int dup2(int oldfd, int newfd)
 	return newfd;
 }
 
+/* fd의 dirty data와 inode를 disk에 write */
+int fsync(int fd)
+{
+	struct file *f = process_get_file(fd);
+	if (f == NULL || f == STDIN || f == STDOUT)
+		return -1;
+
+	file_sync(f);
+	return 0;
+}
+
+/* fd의 offset부터 len byte를 담을 disk 공간을 연속적으로 미리 할당
+ * file 길이는 바뀌지 않는다 */
+int fallocate(int fd, off_t offset, off_t len)
+{
+	if (offset < 0 || len <= 0 || len > INT32_MAX - offset)
+		return -1;
+
+	struct file *f = process_get_file(fd);
+	if (f == NULL || f == STDIN || f == STDOUT)
+		return -1;
+
+	return file_allocate(f, offset + len) ? 0 : -1;
+}
+
+/* whence에 따라 fd의 pos를 옮기고 새 pos를 return, 실패하면 -1
+ * SEEK_DATA와 SEEK_HOLE은 offset 이후의 첫 data, 첫 hole 위치로 옮긴다 */
+off_t lseek(int fd, off_t offset, int whence)
+{
+	struct file *f = process_get_file(fd);
+	if (f == NULL || f == STDIN || f == STDOUT)
+		return -1;
+
+	off_t pos;
+	switch (whence)
+	{
+	case SEEK_SET:
+		pos = offset;
+		break;
+	case SEEK_CUR:
+		pos = file_tell(f) + offset;
+		break;
+	case SEEK_END:
+		pos = file_length(f) + offset;
+		break;
+	case SEEK_DATA:
+		pos = offset < 0 ? -1 : file_seek_data(f, offset);
+		break;
+	case SEEK_HOLE:
+		pos = offset < 0 ? -1 : file_seek_hole(f, offset);
+		break;
+	default:
+		return -1;
+	}
+
+	if (pos < 0)
+		return -1;
+	file_seek(f, pos);
+	return pos;
+}
+
 /**************** project 3: virtual memory *******************/
 void *mmap(void *addr, size_t length, int writable, int fd, off_t offset)
 {
@@ -650,9 +717,7 @@ bool mkdir(const char *dir)
 
 	strlcpy(copy_dir, dir, strlen(dir) + 1);
 
-	lock_acquire(&file_lock);
 	bool succ = filesys_create_dir(copy_dir);
-	lock_release(&file_lock);
 
 	free(copy_dir);
 
@@ -701,9 +766,7 @@ int symlink(const char *target, const char *linkpath)
 	char *copy_linkpath = (char *)malloc(strlen(linkpath) + 1);
 	strlcpy(copy_linkpath, linkpath, strlen(linkpath) + 1);
 
-	lock_acquire(&file_lock);
 	int result = filesys_create_link(target, copy_linkpath);
-	lock_release(&file_lock);
 
 	free(copy_linkpath);
 
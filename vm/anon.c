@@ -58,8 +58,7 @@ anon_swap_in(struct page *page, void *kva)
 	if (!bitmap_test(swap_table, page_no))
 		return false;
 
-	for (int i = 0; i < SECTORS_IN_PAGE; i++)
-		disk_read(swap_disk, (page_no * SECTORS_IN_PAGE) + i, kva + (DISK_SECTOR_SIZE * i));
+	disk_read_multiple(swap_disk, page_no * SECTORS_IN_PAGE, SECTORS_IN_PAGE, kva);
 
 	bitmap_flip(swap_table, page_no);
 
@@ -77,8 +76,7 @@ anon_swap_out(struct page *page)
 	if (page_no == BITMAP_ERROR)
 		return false;
 
-	for (int i = 0; i < SECTORS_IN_PAGE; i++)
-		disk_write(swap_disk, (page_no * SECTORS_IN_PAGE) + i, page->va + (DISK_SECTOR_SIZE * i));
+	disk_write_multiple(swap_disk, page_no * SECTORS_IN_PAGE, SECTORS_IN_PAGE, page->va);
 
 	bitmap_flip(swap_table, page_no);
 